@@ -0,0 +1,311 @@
+#include "Analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Frames per second the analyzer thread renders while signal arrives
+const int frameRate = 30;
+
+// Display ranges
+const float minimumFrequency = 20.0f;
+const float maximumFrequency = 20000.0f;
+const float minimumDecibels = -96.0f;
+const float decibelGridStep = 24.0f;
+
+// Spectrum smoothing per analysis (fraction of the way to the new value)
+const float spectrumAttack = 0.6f;
+const float spectrumRelease = 0.15f;
+
+// Transfer plot persistence per frame, and how fast the axis ranges shrink
+// back after a peak (per frame)
+const float transferDecay = 0.8f;
+const float rangeRelease = 0.97f;
+const float minimumRange = 0.01f;
+
+const juce::Colour backgroundColour(0xff141414);
+const juce::Colour gridColour(0x22ffffff);
+const juce::Colour borderColour(0x33ffffff);
+const juce::Colour inputColour(0xff8a8a8a);
+const juce::Colour outputColour(0xffff9500); // Orange
+} // namespace
+
+Analyzer::Analyzer(fuzza::AnalyzerTap &tapToUse)
+    : juce::Thread("Fuzza analyzer"), tap(tapToUse) {
+  window.resize(fftSize);
+  juce::dsp::WindowingFunction<float>::fillWindowingTables(
+      window.data(), fftSize, juce::dsp::WindowingFunction<float>::hann,
+      false);
+  fftData.resize(2 * fftSize);
+  inputScratch.resize(fuzza::AnalyzerTap::capacity);
+  outputScratch.resize(fuzza::AnalyzerTap::capacity);
+
+  for (auto *spectrum : {&inputSpectrum, &outputSpectrum}) {
+    spectrum->history.assign(fftSize, 0.0f);
+    spectrum->decibels.assign(fftSize / 2 + 1, minimumDecibels);
+  }
+
+  transferDensity.assign(transferSize * transferSize, 0.0f);
+  transferImage = juce::Image(juce::Image::ARGB, transferSize, transferSize,
+                              true, juce::SoftwareImageType());
+
+  setOpaque(false);
+  setInterceptsMouseClicks(false, false);
+
+  tap.setActive(true);
+  startThread(juce::Thread::Priority::low);
+}
+
+Analyzer::~Analyzer() {
+  tap.setActive(false);
+  stopThread(1000);
+}
+
+void Analyzer::refresh() {
+  if (!frameReady.exchange(false))
+    return;
+
+  {
+    const juce::SpinLock::ScopedLockType lock(frameLock);
+    frame = std::move(readyFrame);
+  }
+
+  repaint();
+}
+
+void Analyzer::paint(juce::Graphics &g) {
+  // Tells the analyzer thread what size to render at
+  auto pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+  pixelWidth = juce::roundToInt(getWidth() * pixelScale);
+  pixelHeight = juce::roundToInt(getHeight() * pixelScale);
+  framePixelScale = pixelScale;
+
+  if (frame.isValid())
+    g.drawImage(frame, getLocalBounds().toFloat());
+}
+
+void Analyzer::run() {
+  // Pairs left over from an earlier editor are stale
+  tap.clear();
+
+  int renderedWidth = 0, renderedHeight = 0;
+
+  while (!threadShouldExit()) {
+    tapRate = tap.getTapRate();
+    auto hasSignal = false;
+
+    while (auto numPairs = tap.pop(inputScratch.data(), outputScratch.data(),
+                                   static_cast<int>(inputScratch.size()))) {
+      addPairs(inputScratch.data(), outputScratch.data(), numPairs);
+      hasSignal = true;
+    }
+
+    const auto width = pixelWidth.load();
+    const auto height = pixelHeight.load();
+
+    // Without signal the last frame stays up, unless the size changed
+    if (width > 0 && height > 0 &&
+        (hasSignal || width != renderedWidth || height != renderedHeight)) {
+      auto image = renderFrame(width, height, framePixelScale.load());
+      renderedWidth = width;
+      renderedHeight = height;
+
+      {
+        const juce::SpinLock::ScopedLockType lock(frameLock);
+        readyFrame = std::move(image);
+      }
+
+      frameReady = true;
+    }
+
+    wait(1000 / frameRate);
+  }
+}
+
+void Analyzer::addPairs(const float *input, const float *output,
+                        int numPairs) {
+  float inputPeak = 0.0f, outputPeak = 0.0f;
+
+  for (int i = 0; i < numPairs; ++i) {
+    inputSpectrum.history[static_cast<size_t>(historyPosition)] = input[i];
+    outputSpectrum.history[static_cast<size_t>(historyPosition)] = output[i];
+    historyPosition = (historyPosition + 1) % fftSize;
+
+    if (++samplesSinceAnalysis == hopSize) {
+      samplesSinceAnalysis = 0;
+      analyze(inputSpectrum);
+      analyze(outputSpectrum);
+    }
+
+    inputPeak = juce::jmax(inputPeak, std::abs(input[i]));
+    outputPeak = juce::jmax(outputPeak, std::abs(output[i]));
+
+    // Output up, input right, both centred on zero
+    auto x = static_cast<int>((input[i] / inputRange * 0.5f + 0.5f) *
+                              transferSize);
+    auto y = static_cast<int>((0.5f - output[i] / outputRange * 0.5f) *
+                              transferSize);
+
+    if (juce::isPositiveAndBelow(x, transferSize) &&
+        juce::isPositiveAndBelow(y, transferSize))
+      transferDensity[static_cast<size_t>(y * transferSize + x)] += 1.0f;
+  }
+
+  inputRange = juce::jmax(minimumRange, inputPeak, inputRange * rangeRelease);
+  outputRange =
+      juce::jmax(minimumRange, outputPeak, outputRange * rangeRelease);
+}
+
+void Analyzer::analyze(Spectrum &spectrum) {
+  // Oldest sample first
+  for (int i = 0; i < fftSize; ++i)
+    fftData[static_cast<size_t>(i)] =
+        spectrum.history[static_cast<size_t>((historyPosition + i) % fftSize)] *
+        window[static_cast<size_t>(i)];
+
+  std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+  fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+  // A full-scale sine reads 0 dB (the Hann window's coherent gain is 1/2)
+  const auto magnitudeScale = 4.0f / fftSize;
+
+  for (size_t bin = 0; bin < spectrum.decibels.size(); ++bin) {
+    auto decibels = juce::Decibels::gainToDecibels(
+        fftData[bin] * magnitudeScale, minimumDecibels);
+    auto &smoothed = spectrum.decibels[bin];
+    smoothed += (decibels - smoothed) *
+                (decibels > smoothed ? spectrumAttack : spectrumRelease);
+  }
+}
+
+juce::Image Analyzer::renderFrame(int width, int height, float scale) {
+  juce::Image image(juce::Image::ARGB, width, height, true,
+                    juce::SoftwareImageType());
+  juce::Graphics g(image);
+
+  // Drawn in component units, like the editor's background
+  g.addTransform(juce::AffineTransform::scale(scale));
+  auto bounds = juce::Rectangle<float>(width / scale, height / scale);
+
+  g.setColour(backgroundColour);
+  g.fillRoundedRectangle(bounds, 6.0f);
+  g.setColour(borderColour);
+  g.drawRoundedRectangle(bounds.reduced(0.5f), 6.0f, 1.0f);
+
+  auto area = bounds.reduced(6.0f);
+  auto transferArea = area.removeFromRight(area.getHeight());
+  area.removeFromRight(8.0f);
+
+  drawSpectrum(g, area, inputSpectrum, inputColour, false);
+  drawSpectrum(g, area, outputSpectrum, outputColour, true);
+  drawTransfer(g, transferArea);
+
+  return image;
+}
+
+void Analyzer::drawSpectrum(juce::Graphics &g, juce::Rectangle<float> area,
+                            const Spectrum &spectrum, juce::Colour colour,
+                            bool filled) const {
+  const auto topFrequency =
+      juce::jmin(maximumFrequency, static_cast<float>(tapRate * 0.5));
+  const auto octaves = std::log2(topFrequency / minimumFrequency);
+  const auto binsPerHertz = static_cast<float>(fftSize / tapRate);
+
+  auto toX = [&](float frequency) {
+    return area.getX() +
+           area.getWidth() * std::log2(frequency / minimumFrequency) / octaves;
+  };
+  auto toY = [&](float decibels) {
+    return juce::jmap(juce::jmax(decibels, minimumDecibels), minimumDecibels,
+                      0.0f, area.getBottom(), area.getY());
+  };
+
+  // The grid is drawn once, under the first spectrum
+  if (!filled) {
+    g.setColour(gridColour);
+
+    for (auto frequency : {100.0f, 1000.0f, 10000.0f})
+      if (frequency < topFrequency)
+        g.drawVerticalLine(juce::roundToInt(toX(frequency)), area.getY(),
+                           area.getBottom());
+
+    for (auto decibels = -decibelGridStep; decibels > minimumDecibels;
+         decibels -= decibelGridStep)
+      g.drawHorizontalLine(juce::roundToInt(toY(decibels)), area.getX(),
+                           area.getRight());
+  }
+
+  // One point per unit of width: the loudest bin in its frequency range, or
+  // an interpolated one where the bins are wider than that
+  juce::Path path;
+  const auto numPoints = juce::jmax(2, static_cast<int>(area.getWidth()));
+  const auto lastBin = static_cast<float>(spectrum.decibels.size() - 1);
+
+  for (int point = 0; point <= numPoints; ++point) {
+    auto proportion = static_cast<float>(point) / numPoints;
+    auto nextProportion = static_cast<float>(point + 1) / numPoints;
+    auto firstBin = juce::jmin(
+        lastBin, minimumFrequency * std::exp2(octaves * proportion) *
+                     binsPerHertz);
+    auto endBin = juce::jmin(
+        lastBin, minimumFrequency * std::exp2(octaves * nextProportion) *
+                     binsPerHertz);
+
+    float decibels;
+
+    if (endBin - firstBin < 1.0f) {
+      auto index = static_cast<size_t>(firstBin);
+      auto next = juce::jmin(index + 1, spectrum.decibels.size() - 1);
+      decibels = juce::jmap(firstBin - static_cast<float>(index),
+                            spectrum.decibels[index], spectrum.decibels[next]);
+    } else {
+      decibels = minimumDecibels;
+
+      for (auto bin = static_cast<size_t>(firstBin);
+           bin <= static_cast<size_t>(endBin); ++bin)
+        decibels = juce::jmax(decibels, spectrum.decibels[bin]);
+    }
+
+    auto x = area.getX() + area.getWidth() * proportion;
+
+    if (point == 0)
+      path.startNewSubPath(x, toY(decibels));
+    else
+      path.lineTo(x, toY(decibels));
+  }
+
+  if (filled) {
+    auto fill = path;
+    fill.lineTo(area.getRight(), area.getBottom());
+    fill.lineTo(area.getX(), area.getBottom());
+    fill.closeSubPath();
+    g.setColour(colour.withAlpha(0.25f));
+    g.fillPath(fill);
+  }
+
+  g.setColour(colour);
+  g.strokePath(path, juce::PathStrokeType(1.0f));
+}
+
+void Analyzer::drawTransfer(juce::Graphics &g, juce::Rectangle<float> area) {
+  // Density to opacity, then fade for the next frame
+  for (int y = 0; y < transferSize; ++y)
+    for (int x = 0; x < transferSize; ++x) {
+      auto &density = transferDensity[static_cast<size_t>(y * transferSize + x)];
+      auto opacity = 1.0f - std::exp(-0.5f * density);
+      transferImage.setPixelAt(x, y, outputColour.withAlpha(opacity));
+      density *= transferDecay;
+    }
+
+  g.setColour(gridColour);
+  g.drawHorizontalLine(juce::roundToInt(area.getCentreY()), area.getX(),
+                       area.getRight());
+  g.drawVerticalLine(juce::roundToInt(area.getCentreX()), area.getY(),
+                     area.getBottom());
+
+  g.setImageResamplingQuality(juce::Graphics::mediumResamplingQuality);
+  g.drawImage(transferImage, area);
+
+  g.setColour(borderColour);
+  g.drawRect(area, 1.0f);
+}
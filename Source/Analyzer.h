@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "DSP/AnalyzerTap.h"
+
+#include <atomic>
+#include <vector>
+
+// Spectrum and transfer-curve display: input and output spectra on a log
+// frequency axis, and a persistence plot of output against input samples
+// next to them (the clipper's curve, as the tone filter and cabinet leave
+// it).
+//
+// Everything is computed and drawn on the analyzer's own thread: it drains
+// the processor's AnalyzerTap, runs windowed FFTs, smooths the spectra and
+// renders each frame into an image at the display's pixel size. The message
+// thread only picks up finished frames and blits them. The tap captures
+// only while an Analyzer exists, so closing the editor stops all of it.
+class Analyzer : public juce::Component, private juce::Thread {
+public:
+  explicit Analyzer(fuzza::AnalyzerTap &tapToUse);
+  ~Analyzer() override;
+
+  // Message thread (the editor's timer): shows the newest finished frame
+  void refresh();
+
+  void paint(juce::Graphics &) override;
+
+private:
+  // 2048-point FFTs every 1024 tap samples (about 21 ms at 48 kHz)
+  static constexpr int fftOrder = 11;
+  static constexpr int fftSize = 1 << fftOrder;
+  static constexpr int hopSize = fftSize / 2;
+
+  // Transfer plot resolution (cells per axis)
+  static constexpr int transferSize = 128;
+
+  // One signal's FFT input history and smoothed spectrum (dB per bin)
+  struct Spectrum {
+    std::vector<float> history;
+    std::vector<float> decibels;
+  };
+
+  void run() override;
+
+  // Analyzer thread
+  void addPairs(const float *input, const float *output, int numPairs);
+  void analyze(Spectrum &spectrum);
+  juce::Image renderFrame(int width, int height, float scale);
+  void drawSpectrum(juce::Graphics &g, juce::Rectangle<float> area,
+                    const Spectrum &spectrum, juce::Colour colour,
+                    bool filled) const;
+  void drawTransfer(juce::Graphics &g, juce::Rectangle<float> area);
+
+  fuzza::AnalyzerTap &tap;
+
+  // Analyzer thread only
+  juce::dsp::FFT fft{fftOrder};
+  std::vector<float> window, fftData;
+  std::vector<float> inputScratch, outputScratch;
+  Spectrum inputSpectrum, outputSpectrum;
+  int historyPosition = 0;
+  int samplesSinceAnalysis = 0;
+  double tapRate = 44100.0;
+
+  // Output-against-input density, fading every frame, and the axis ranges
+  // following the signal's peaks
+  std::vector<float> transferDensity;
+  float inputRange = 0.1f, outputRange = 0.1f;
+  juce::Image transferImage;
+
+  // Pixel size and pixels per component unit the message thread last
+  // painted at
+  std::atomic<int> pixelWidth{0}, pixelHeight{0};
+  std::atomic<float> framePixelScale{1.0f};
+
+  // Analyzer thread -> message thread
+  juce::SpinLock frameLock;
+  juce::Image readyFrame;
+  std::atomic<bool> frameReady{false};
+
+  // Message thread only
+  juce::Image frame;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Analyzer)
+};
@@ -0,0 +1,152 @@
+#include "BinaryState.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace fuzza {
+
+namespace {
+const char magic[4] = {'F', 'Z', 'S', 'T'};
+
+void writeUint16(juce::uint8 *destination, juce::uint16 value) {
+  value = juce::ByteOrder::swapIfBigEndian(value);
+  std::memcpy(destination, &value, sizeof(value));
+}
+
+void writeUint32(juce::uint8 *destination, juce::uint32 value) {
+  value = juce::ByteOrder::swapIfBigEndian(value);
+  std::memcpy(destination, &value, sizeof(value));
+}
+
+void writeFloat(juce::uint8 *destination, float value) {
+  juce::uint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  writeUint32(destination, bits);
+}
+
+float readFloat(const juce::uint8 *source) {
+  auto bits = juce::ByteOrder::littleEndianInt(source);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+} // namespace
+
+BinaryState::BinaryState(juce::AudioProcessorValueTreeState &state) {
+  for (size_t i = 0; i < parameterIds.size(); ++i) {
+    parameters[i] = state.getParameter(parameterIds[i]);
+    jassert(parameters[i] != nullptr); // Keep parameterIds in sync
+  }
+}
+
+BinaryState::Values BinaryState::getDefaultValues() const {
+  Values values{};
+
+  for (size_t i = 0; i < parameters.size(); ++i)
+    values[i] = parameters[i]->convertFrom0to1(parameters[i]->getDefaultValue());
+
+  return values;
+}
+
+float BinaryState::constrain(size_t index, float value) const {
+  auto *parameter = parameters[index];
+  return parameter->convertFrom0to1(parameter->convertTo0to1(value));
+}
+
+juce::uint32 BinaryState::checksum(const juce::uint8 *data, size_t size) {
+  juce::uint32 hash = 0x811c9dc5u;
+
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 0x01000193u;
+  }
+
+  return hash;
+}
+
+void BinaryState::write(juce::MemoryBlock &destination,
+                        const juce::String &impulseResponsePath) const {
+  const auto valuesEnd = headerSize + parameters.size() * sizeof(float);
+
+  // A path too long for its length field is left out rather than cut: cut
+  // short it would name another file, and could end mid-character
+  const auto pathBytes = impulseResponsePath.getNumBytesAsUTF8();
+  const auto pathSize = pathBytes <= maximumPathSize ? pathBytes : size_t{0};
+  const auto payloadSize = valuesEnd + pathSizeSize + pathSize;
+
+  destination.setSize(payloadSize + checksumSize);
+  auto *bytes = static_cast<juce::uint8 *>(destination.getData());
+
+  std::memcpy(bytes, magic, sizeof(magic));
+  writeUint16(bytes + 4, formatVersion);
+  writeUint16(bytes + 6, static_cast<juce::uint16>(parameters.size()));
+
+  for (size_t i = 0; i < parameters.size(); ++i)
+    writeFloat(bytes + headerSize + i * sizeof(float),
+               parameters[i]->convertFrom0to1(parameters[i]->getValue()));
+
+  writeUint16(bytes + valuesEnd, static_cast<juce::uint16>(pathSize));
+  std::memcpy(bytes + valuesEnd + pathSizeSize,
+              impulseResponsePath.toRawUTF8(), pathSize);
+
+  writeUint32(bytes + payloadSize, checksum(bytes, payloadSize));
+}
+
+bool BinaryState::read(const void *data, int sizeInBytes,
+                       juce::String &impulseResponsePath) {
+  if (data == nullptr || sizeInBytes < static_cast<int>(headerSize + checksumSize))
+    return false;
+
+  const auto *bytes = static_cast<const juce::uint8 *>(data);
+  const auto size = static_cast<size_t>(sizeInBytes);
+
+  if (std::memcmp(bytes, magic, sizeof(magic)) != 0)
+    return false;
+
+  const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+  const auto numValues =
+      static_cast<size_t>(juce::ByteOrder::littleEndianShort(bytes + 6));
+  const auto valuesEnd = headerSize + numValues * sizeof(float);
+
+  if (version == 0 || version > formatVersion || size < valuesEnd + checksumSize)
+    return false;
+
+  // Version 2 added the IR path after the values
+  size_t pathSize = 0;
+
+  if (version >= 2) {
+    if (size < valuesEnd + pathSizeSize + checksumSize)
+      return false;
+
+    pathSize = juce::ByteOrder::littleEndianShort(bytes + valuesEnd);
+  }
+
+  const auto payloadSize =
+      valuesEnd + (version >= 2 ? pathSizeSize + pathSize : 0);
+
+  if (size < payloadSize + checksumSize ||
+      juce::ByteOrder::littleEndianInt(bytes + payloadSize) !=
+          checksum(bytes, payloadSize))
+    return false;
+
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    auto *parameter = parameters[i];
+    auto value = parameter->getDefaultValue();
+
+    if (i < numValues) {
+      auto stored = readFloat(bytes + headerSize + i * sizeof(float));
+
+      if (std::isfinite(stored))
+        value = parameter->convertTo0to1(stored);
+    }
+
+    parameter->setValueNotifyingHost(value);
+  }
+
+  impulseResponsePath = juce::String::fromUTF8(
+      reinterpret_cast<const char *>(bytes + valuesEnd + pathSizeSize),
+      static_cast<int>(pathSize));
+  return true;
+}
+
+} // namespace fuzza
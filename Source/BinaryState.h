@@ -0,0 +1,103 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <array>
+
+namespace fuzza {
+
+// Compact binary plugin state: the parameter values in a fixed order and the
+// cabinet IR file, with no XML DOM on either side.
+//
+// Layout (little endian):
+//
+//   0      char[4]   magic "FZST"
+//   4      uint16    format version
+//   6      uint16    number of values N
+//   8      float32   N parameter values, in parameter units, in
+//                    parameterIds order
+//   8+4N   uint16    length M of the cabinet IR path (version 2)
+//   10+4N  char[M]   cabinet IR path, UTF-8, empty for none (version 2);
+//                    a longer path than M can hold is written as none
+//   ...    uint32    FNV-1a checksum of everything before it
+//
+// 118 bytes plus the path for the current parameter set, against ~1400 for
+// the XML form.
+// parameterIds is append-only: new parameters go at the end, and states with
+// fewer values restore the missing parameters to their defaults. Anything
+// else (reordering, changing a parameter's units) needs a new version.
+class BinaryState {
+public:
+  static constexpr juce::uint16 formatVersion = 2;
+
+  static constexpr std::array<const char *, 26> parameterIds{
+      "BYPASS",          "GAIN",           "TONE",
+      "MIX",             "GATE",           "GATE_HOLD",
+      "GATE_HYSTERESIS", "CLIP_MODE",      "ANTIALIAS",
+      "OVERSAMPLING",    "PRECISION",      "CABINET",
+      "BANDS",           "CROSSOVER_LOW",  "CROSSOVER_MID",
+      "CROSSOVER_HIGH",  "BAND1_GAIN",     "BAND2_GAIN",
+      "BAND3_GAIN",      "BAND4_GAIN",     "BAND1_CLIP",
+      "BAND2_CLIP",      "BAND3_CLIP",     "BAND4_CLIP",
+      "QUALITY",         "QUALITY_BUDGET"};
+
+  // Position of each parameter in parameterIds
+  enum Index : size_t {
+    bypass,
+    gain,
+    tone,
+    mix,
+    gate,
+    gateHold,
+    gateHysteresis,
+    clipMode,
+    antialias,
+    oversampling,
+    precision,
+    cabinet,
+    bands,
+    crossoverLow,
+    crossoverMid,
+    crossoverHigh,
+    band1Gain,
+    band2Gain,
+    band3Gain,
+    band4Gain,
+    band1Clip,
+    band2Clip,
+    band3Clip,
+    band4Clip,
+    quality,
+    qualityBudget
+  };
+
+  // Parameter values in parameter units, in parameterIds order
+  using Values = std::array<float, parameterIds.size()>;
+
+  explicit BinaryState(juce::AudioProcessorValueTreeState &state);
+
+  Values getDefaultValues() const;
+
+  // The value the parameter holds after being set to value (clamped to its
+  // range and snapped to its interval or choices)
+  float constrain(size_t index, float value) const;
+
+  void write(juce::MemoryBlock &destination,
+             const juce::String &impulseResponsePath) const;
+
+  // Restores the parameters and returns the IR path (empty before version
+  // 2). False (and nothing changed) if the data is not a binary state, is
+  // damaged, or comes from a newer format version.
+  bool read(const void *data, int sizeInBytes,
+            juce::String &impulseResponsePath);
+
+private:
+  static constexpr size_t headerSize = 8, pathSizeSize = 2, checksumSize = 4;
+  static constexpr size_t maximumPathSize = 0xffff;
+
+  static juce::uint32 checksum(const juce::uint8 *data, size_t size);
+
+  std::array<juce::RangedAudioParameter *, parameterIds.size()> parameters{};
+};
+
+} // namespace fuzza
@@ -0,0 +1,196 @@
+#include "AnalyzerTap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fuzza {
+
+namespace {
+// Captured rates below this are not decimated further
+const double minimumTapRate = 44100.0;
+} // namespace
+
+void AnalyzerTap::prepare(double sampleRate, int maximumBlockSize,
+                          int maximumLatencySamples) {
+  decimation = 1;
+  numStages = 0;
+
+  while (numStages < maxStages &&
+         sampleRate / (2 * decimation) >= minimumTapRate) {
+    decimation *= 2;
+    ++numStages;
+  }
+
+  tapRate = sampleRate / decimation;
+
+  // Half-band low-pass: every other tap but the centre is zero
+  const auto centre = halfBandTaps / 2;
+  auto sum = 0.0;
+
+  for (int tap = 0; tap < halfBandTaps; ++tap) {
+    const auto n = tap - centre;
+    const auto phase =
+        juce::MathConstants<double>::twoPi * tap / (halfBandTaps - 1);
+    const auto window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2 * phase);
+    const auto sinc =
+        n == 0 ? 0.5
+               : std::sin(juce::MathConstants<double>::halfPi * n) /
+                     (juce::MathConstants<double>::pi * n);
+    halfBand[static_cast<size_t>(tap)] = static_cast<float>(sinc * window);
+    sum += sinc * window;
+  }
+
+  for (auto &coefficient : halfBand)
+    coefficient = static_cast<float>(coefficient / sum);
+
+  const auto maximumTapSamples = juce::jmax(1, maximumBlockSize) / decimation + 1;
+  blockInput.assign(static_cast<size_t>(maximumTapSamples), 0.0f);
+  blockOutput.assign(static_cast<size_t>(maximumTapSamples), 0.0f);
+
+  inputDelay.assign(static_cast<size_t>(juce::jmax(0, maximumLatencySamples) + 1),
+                    0.0f);
+  inputDelayPosition = 0;
+
+  numBlockInputs = 0;
+  capturing = captured = false;
+  inputDecimator = {};
+  outputDecimator = {};
+}
+
+void AnalyzerTap::setActive(bool shouldBeActive) {
+  active.store(shouldBeActive, std::memory_order_release);
+}
+
+bool AnalyzerTap::decimateSample(Decimator &decimator, float &sample) const {
+  for (int stage = 0; stage < numStages; ++stage) {
+    auto &state = decimator.stages[static_cast<size_t>(stage)];
+    state.history[static_cast<size_t>(state.position)] = sample;
+    state.history[static_cast<size_t>(state.position + halfBandTaps)] = sample;
+    state.position = (state.position + 1) % halfBandTaps;
+    state.outputDue = !state.outputDue;
+
+    if (!state.outputDue)
+      return false;
+
+    // Oldest input first
+    const auto *history = state.history.data() + state.position;
+    auto output = 0.0f;
+
+    for (int tap = 0; tap < halfBandTaps; ++tap)
+      output += halfBand[static_cast<size_t>(tap)] * history[tap];
+
+    sample = output;
+  }
+
+  return true;
+}
+
+template <typename SampleType>
+int AnalyzerTap::decimate(const juce::AudioBuffer<SampleType> &buffer,
+                          int numChannels, Decimator &decimator,
+                          float *destination, int delaySamples) {
+  const auto numSamples = buffer.getNumSamples();
+  const auto maximumTapSamples = static_cast<int>(blockInput.size());
+  const auto channelScale = 1.0f / static_cast<float>(juce::jmax(1, numChannels));
+  const auto delayLength = static_cast<int>(inputDelay.size());
+  delaySamples = juce::jlimit(0, delayLength - 1, delaySamples);
+  int numTapSamples = 0;
+
+  for (int sample = 0; sample < numSamples; ++sample) {
+    float mono = 0.0f;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+      mono += static_cast<float>(buffer.getSample(channel, sample));
+
+    mono *= channelScale;
+
+    if (delaySamples > 0) {
+      inputDelay[static_cast<size_t>(inputDelayPosition)] = mono;
+      mono = inputDelay[static_cast<size_t>(
+          (inputDelayPosition - delaySamples + delayLength) % delayLength)];
+      inputDelayPosition = (inputDelayPosition + 1) % delayLength;
+    }
+
+    decimator.count = (decimator.count + 1) % decimation;
+
+    // A block beyond the prepared size only loses its last tap samples
+    if (decimateSample(decimator, mono) && numTapSamples < maximumTapSamples)
+      destination[numTapSamples++] = mono;
+  }
+
+  return numTapSamples;
+}
+
+template <typename SampleType>
+void AnalyzerTap::captureInput(const juce::AudioBuffer<SampleType> &buffer,
+                               int numChannels, int latencySamples) {
+  const auto wasCapturing = captured;
+  capturing = captured =
+      active.load(std::memory_order_acquire) && !blockInput.empty();
+
+  if (!capturing)
+    return;
+
+  // Both decimators advance in step; a block that was only half captured
+  // (activated between the two calls) starts them over together. Input
+  // delayed from before a pause is stale.
+  if (!wasCapturing || inputDecimator.count != outputDecimator.count) {
+    inputDecimator = outputDecimator = {};
+    std::fill(inputDelay.begin(), inputDelay.end(), 0.0f);
+  }
+
+  numBlockInputs = decimate(buffer, numChannels, inputDecimator,
+                            blockInput.data(), latencySamples);
+}
+
+template <typename SampleType>
+void AnalyzerTap::captureOutput(const juce::AudioBuffer<SampleType> &buffer,
+                                int numChannels) {
+  if (!capturing)
+    return;
+
+  capturing = false;
+  const auto numPairs = juce::jmin(
+      numBlockInputs,
+      decimate(buffer, numChannels, outputDecimator, blockOutput.data(), 0));
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(numPairs, start1, size1, start2, size2);
+
+  // Whatever does not fit is dropped
+  std::copy_n(blockInput.data(), size1, inputs.data() + start1);
+  std::copy_n(blockOutput.data(), size1, outputs.data() + start1);
+  std::copy_n(blockInput.data() + size1, size2, inputs.data() + start2);
+  std::copy_n(blockOutput.data() + size1, size2, outputs.data() + start2);
+  fifo.finishedWrite(size1 + size2);
+}
+
+int AnalyzerTap::pop(float *input, float *output, int maxPairs) {
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(maxPairs, start1, size1, start2, size2);
+
+  std::copy_n(inputs.data() + start1, size1, input);
+  std::copy_n(outputs.data() + start1, size1, output);
+  std::copy_n(inputs.data() + start2, size2, input + size1);
+  std::copy_n(outputs.data() + start2, size2, output + size1);
+  fifo.finishedRead(size1 + size2);
+
+  return size1 + size2;
+}
+
+void AnalyzerTap::clear() {
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+  fifo.finishedRead(size1 + size2);
+}
+
+template void AnalyzerTap::captureInput<float>(const juce::AudioBuffer<float> &,
+                                               int, int);
+template void
+AnalyzerTap::captureInput<double>(const juce::AudioBuffer<double> &, int, int);
+template void
+AnalyzerTap::captureOutput<float>(const juce::AudioBuffer<float> &, int);
+template void
+AnalyzerTap::captureOutput<double>(const juce::AudioBuffer<double> &, int);
+
+} // namespace fuzza
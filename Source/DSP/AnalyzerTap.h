@@ -0,0 +1,100 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace fuzza {
+
+// Audio-thread side of the editor's analyzer: input and output of each
+// block, mixed to mono and decimated by a power of two to 44.1-88.2 kHz, as
+// sample pairs in a single-producer/single-consumer ring
+// (juce::AbstractFifo). The input is delayed by the processor's latency, so
+// each pair holds an input sample and the output it produced.
+//
+// Capturing costs one flag test per block while no analyzer is open, and a
+// mono mix plus a ring write per tap sample while one is (plus the
+// decimation filters above 88.2 kHz). It never blocks or allocates; if the
+// analyzer falls behind, pairs are dropped.
+//
+// Each factor of two is a 63-tap half-band low-pass (Blackman-windowed
+// sinc), flat to 0.2 of its input rate and at least 75 dB down from 0.3.
+// The fuzz's ultrasonic harmonics fold back only above 0.4 of the tap rate
+// (19.2 kHz at a 48 kHz tap), not over the audible range of the display.
+class AnalyzerTap {
+public:
+  // Pairs buffered for the analyzer (about 0.35 s at the tap rate)
+  static constexpr int capacity = 16384;
+
+  // Call from prepareToPlay, before the audio thread captures; may allocate
+  void prepare(double sampleRate, int maximumBlockSize,
+               int maximumLatencySamples);
+
+  // Rate of the captured pairs (Hz)
+  double getTapRate() const { return tapRate.load(); }
+
+  // Message thread. Nothing is captured while inactive.
+  void setActive(bool shouldBeActive);
+
+  // Audio thread: the block before and after processing. The input is
+  // delayed by latencySamples (at most the prepared maximum) to line up with
+  // the output. Output is only captured for a block whose input was.
+  template <typename SampleType>
+  void captureInput(const juce::AudioBuffer<SampleType> &buffer,
+                    int numChannels, int latencySamples);
+  template <typename SampleType>
+  void captureOutput(const juce::AudioBuffer<SampleType> &buffer,
+                     int numChannels);
+
+  // Analyzer thread only. Copies up to maxPairs pairs and returns how many.
+  int pop(float *input, float *output, int maxPairs);
+
+  // Analyzer thread only. Discards everything buffered.
+  void clear();
+
+private:
+  static constexpr int halfBandTaps = 63;
+  static constexpr int maxStages = 5; // Up to 32x, 1.4 MHz
+
+  // One factor of two: the last halfBandTaps inputs, stored twice so the
+  // filter reads them without wrapping, and whether an output is due
+  struct HalfBandStage {
+    std::array<float, 2 * halfBandTaps> history{};
+    int position = 0;
+    bool outputDue = false;
+  };
+
+  struct Decimator {
+    std::array<HalfBandStage, maxStages> stages;
+    int count = 0; // Samples since the last tap sample
+  };
+
+  // Feeds one sample; true (and sample replaced) when a tap sample is out
+  bool decimateSample(Decimator &decimator, float &sample) const;
+
+  template <typename SampleType>
+  int decimate(const juce::AudioBuffer<SampleType> &buffer, int numChannels,
+               Decimator &decimator, float *destination, int delaySamples);
+
+  std::atomic<double> tapRate{44100.0};
+  int decimation = 1, numStages = 0;
+  std::array<float, halfBandTaps> halfBand{};
+  std::atomic<bool> active{false};
+
+  // Audio thread: this block's decimated input, waiting for its output
+  std::vector<float> blockInput, blockOutput;
+  int numBlockInputs = 0;
+  bool capturing = false, captured = false;
+  Decimator inputDecimator, outputDecimator;
+
+  // Audio thread: mono input at the host rate, delayed to match the output
+  std::vector<float> inputDelay;
+  int inputDelayPosition = 0;
+
+  juce::AbstractFifo fifo{capacity};
+  std::array<float, capacity> inputs{}, outputs{};
+};
+
+} // namespace fuzza
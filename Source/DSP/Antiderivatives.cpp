@@ -0,0 +1,113 @@
+#include "Antiderivatives.h"
+
+#include <array>
+#include <vector>
+
+namespace fuzza::waveshaper {
+
+namespace {
+const double ln2 = 0.69314718055994530942;
+const double piSquaredOver24 = 0.41123351671205660911; // pi^2 / 24
+
+// Dilogarithm Li2(z) for z in [-1, 0), by the Bernoulli series in
+// t = -log(1 - z), |t| <= log 2 (converges to double precision by B16)
+double dilogarithm(double z) {
+  // B0, B1, B2, B4, ..., B16 (odd ones above B1 are zero)
+  const std::array<double, 10> bernoulli = {
+      1.0,          -0.5,     1.0 / 6.0,      -1.0 / 30.0,  1.0 / 42.0,
+      -1.0 / 30.0,  5.0 / 66.0, -691.0 / 2730.0, 7.0 / 6.0, -3617.0 / 510.0};
+
+  const auto t = -std::log1p(-z);
+  auto power = t;      // t^(n + 1)
+  auto factorial = 1.0; // (n + 1)!
+  auto sum = 0.0;
+
+  for (int n = 0; n <= 16; ++n) {
+    if (n < 2 || n % 2 == 0)
+      sum += bernoulli[static_cast<size_t>(n < 2 ? n : n / 2 + 1)] * power /
+             factorial;
+
+    power *= t;
+    factorial *= n + 2;
+  }
+
+  return sum;
+}
+
+// For x >= 0: log cosh x, and its integral from 0
+double logCosh(double x) { return x - ln2 + std::log1p(std::exp(-2.0 * x)); }
+
+double logCoshIntegral(double x) {
+  return 0.5 * x * x - x * ln2 + 0.5 * dilogarithm(-std::exp(-2.0 * x)) +
+         piSquaredOver24;
+}
+
+// Cubic Hermite interpolation between two nodes spaced h apart
+double hermite(double t, double h, double p0, double m0, double p1,
+               double m1) {
+  const auto t2 = t * t;
+  const auto t3 = t2 * t;
+  return (2.0 * t3 - 3.0 * t2 + 1.0) * p0 + (t3 - 2.0 * t2 + t) * h * m0 +
+         (-2.0 * t3 + 3.0 * t2) * p1 + (t3 - t2) * h * m1;
+}
+} // namespace
+
+// tanh, F1 and F2 at the nodes; each is the derivative of the next
+struct TanhAntiderivatives::Tables {
+  static constexpr double spacing = maxInput / numIntervals;
+
+  std::vector<double> tanh, F1, F2;
+
+  Tables() {
+    for (int i = 0; i <= numIntervals + 1; ++i) { // One guard node
+      auto x = juce::jmin(i, numIntervals) * spacing;
+      tanh.push_back(std::tanh(x));
+      F1.push_back(logCosh(x));
+      F2.push_back(logCoshIntegral(x));
+    }
+  }
+};
+
+const TanhAntiderivatives::Tables &TanhAntiderivatives::getTables() {
+  static const Tables tables;
+  return tables;
+}
+
+void TanhAntiderivatives::initialise() { getTables(); }
+
+double TanhAntiderivatives::F1(double x) {
+  auto a = std::abs(x);
+
+  if (a >= maxInput)
+    return a - ln2;
+
+  const auto &tables = getTables();
+  auto position = a / Tables::spacing;
+  auto index = static_cast<size_t>(position);
+  auto t = position - static_cast<double>(index);
+
+  return hermite(t, Tables::spacing, tables.F1[index], tables.tanh[index],
+                 tables.F1[index + 1], tables.tanh[index + 1]);
+}
+
+double TanhAntiderivatives::F2(double x) {
+  auto a = std::abs(x);
+  double y;
+
+  if (a >= maxInput) {
+    y = 0.5 * a * a - a * ln2 + piSquaredOver24;
+  } else {
+    const auto &tables = getTables();
+    auto position = a / Tables::spacing;
+    auto index = static_cast<size_t>(position);
+    auto t = position - static_cast<double>(index);
+
+    y = hermite(t, Tables::spacing, tables.F2[index], tables.F1[index],
+                tables.F2[index + 1], tables.F1[index + 1]);
+  }
+
+  // F2 is odd
+  return x < 0.0 ? -y : y;
+}
+
+} // namespace fuzza::waveshaper
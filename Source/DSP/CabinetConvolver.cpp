@@ -0,0 +1,672 @@
+#include "CabinetConvolver.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+#include <dispatch/dispatch.h>
+#else
+#include <cerrno>
+#include <semaphore.h>
+#endif
+
+namespace fuzza {
+
+namespace {
+// Target tail block length (rounded up to a power of two): the worker's
+// deadline, and the body's reach (2L)
+const double tailBlockSeconds = 0.01;
+
+// Resampling kernel half-width, in zero crossings of the lower rate
+const int resamplerZeroCrossings = 16;
+
+// Interleaved complex multiply-accumulate: accumulator += a * b
+void multiplyAdd(float *accumulator, const float *a, const float *b,
+                 int numBins) {
+  for (int i = 0; i < 2 * numBins; i += 2) {
+    accumulator[i] += a[i] * b[i] - a[i + 1] * b[i + 1];
+    accumulator[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+  }
+}
+
+// Blackman-windowed sinc resampling, low-passed at the lower of the two
+// Nyquist frequencies. Runs once per IR off the audio thread.
+juce::AudioBuffer<float> resample(const juce::AudioBuffer<float> &source,
+                                  double sourceRate, double sampleRate,
+                                  int maxLength) {
+  const auto ratio = sourceRate / sampleRate;
+  const auto length = juce::jmin(
+      maxLength,
+      static_cast<int>(std::ceil(source.getNumSamples() / ratio)));
+
+  juce::AudioBuffer<float> result(source.getNumChannels(), length);
+
+  if (ratio == 1.0) {
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+      result.copyFrom(channel, 0, source, channel, 0, length);
+
+    return result;
+  }
+
+  const auto cutoff = juce::jmin(1.0, 1.0 / ratio);
+  const auto halfWidth = resamplerZeroCrossings / cutoff; // Source samples
+  const auto numSource = source.getNumSamples();
+
+  for (int channel = 0; channel < source.getNumChannels(); ++channel) {
+    const auto *input = source.getReadPointer(channel);
+    auto *output = result.getWritePointer(channel);
+
+    for (int sample = 0; sample < length; ++sample) {
+      const auto centre = sample * ratio;
+      const auto first = juce::jmax(0, static_cast<int>(std::ceil(centre - halfWidth)));
+      const auto last =
+          juce::jmin(numSource - 1, static_cast<int>(std::floor(centre + halfWidth)));
+      double sum = 0.0;
+
+      for (int k = first; k <= last; ++k) {
+        const auto x = centre - k;
+        const auto u = x / halfWidth;
+        const auto window = 0.42 + 0.5 * std::cos(juce::MathConstants<double>::pi * u) +
+                            0.08 * std::cos(juce::MathConstants<double>::twoPi * u);
+        const auto phase = juce::MathConstants<double>::pi * cutoff * x;
+        const auto sinc = x == 0.0 ? 1.0 : std::sin(phase) / phase;
+
+        sum += input[k] * cutoff * sinc * window;
+      }
+
+      output[sample] = static_cast<float>(sum);
+    }
+  }
+
+  return result;
+}
+
+// Scales the IR to unit energy per channel on average, so a cabinet keeps
+// roughly the level of the signal it replaces
+void normalise(juce::AudioBuffer<float> &impulseResponse) {
+  double energy = 0.0;
+
+  for (int channel = 0; channel < impulseResponse.getNumChannels(); ++channel)
+    for (int sample = 0; sample < impulseResponse.getNumSamples(); ++sample)
+      energy += juce::square(
+          static_cast<double>(impulseResponse.getSample(channel, sample)));
+
+  energy /= juce::jmax(1, impulseResponse.getNumChannels());
+
+  if (energy > 0.0)
+    impulseResponse.applyGain(static_cast<float>(1.0 / std::sqrt(energy)));
+}
+
+//==============================================================================
+// Uniform partitioned overlap-save convolution of one IR segment, block B
+// and FFT size 2B. Each input block goes through the FFT once into a
+// frequency-domain delay line; each output block is the sum over the delay
+// line times the segment's partition spectra, so the cost per block grows
+// with the number of partitions only by complex multiply-adds.
+class PartitionedStage {
+public:
+  // Partitions IR samples [begin, end) for numChannels channels
+  void prepare(const juce::AudioBuffer<float> &impulseResponse, int begin,
+               int end, int newBlockSize, int numChannels) {
+    blockSize = newBlockSize;
+    fftSize = 2 * blockSize;
+    spectrumSize = fftSize + 2; // blockSize + 1 complex bins
+
+    const auto length =
+        juce::jmax(0, juce::jmin(end, impulseResponse.getNumSamples()) - begin);
+    numPartitions = (length + blockSize - 1) / blockSize;
+
+    if (numPartitions == 0)
+      return;
+
+    fft = std::make_unique<juce::dsp::FFT>(
+        juce::findHighestSetBit(static_cast<juce::uint32>(fftSize)));
+    work.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+
+    partitions.resize(static_cast<size_t>(impulseResponse.getNumChannels()));
+
+    for (int irChannel = 0; irChannel < impulseResponse.getNumChannels();
+         ++irChannel) {
+      auto &spectra = partitions[static_cast<size_t>(irChannel)];
+      spectra.assign(static_cast<size_t>(numPartitions * spectrumSize), 0.0f);
+
+      for (int k = 0; k < numPartitions; ++k) {
+        const auto offset = begin + k * blockSize;
+        const auto count = juce::jmin(blockSize, begin + length - offset);
+
+        std::fill(work.begin(), work.end(), 0.0f);
+        std::copy_n(impulseResponse.getReadPointer(irChannel, offset), count,
+                    work.begin());
+        fft->performRealOnlyForwardTransform(work.data(), true);
+        std::copy_n(work.begin(), spectrumSize,
+                    spectra.begin() + k * spectrumSize);
+      }
+    }
+
+    channels.resize(static_cast<size_t>(numChannels));
+
+    for (size_t channel = 0; channel < channels.size(); ++channel) {
+      auto &state = channels[channel];
+      state.frame.assign(static_cast<size_t>(fftSize), 0.0f);
+      state.delayLine.assign(static_cast<size_t>(numPartitions * spectrumSize),
+                             0.0f);
+      state.partitions = partitions[channel % partitions.size()].data();
+    }
+  }
+
+  void reset() {
+    for (auto &state : channels) {
+      std::fill(state.frame.begin(), state.frame.end(), 0.0f);
+      std::fill(state.delayLine.begin(), state.delayLine.end(), 0.0f);
+      state.position = 0;
+    }
+  }
+
+  int getNumPartitions() const { return numPartitions; }
+
+  // Takes the next blockSize input samples of the channel and writes the
+  // segment's output for the same span
+  void process(int channel, const float *input, float *output) {
+    auto &state = channels[static_cast<size_t>(channel)];
+
+    // Frame: previous block, then this one
+    std::copy(state.frame.begin() + blockSize, state.frame.end(),
+              state.frame.begin());
+    std::copy_n(input, blockSize, state.frame.begin() + blockSize);
+
+    std::copy(state.frame.begin(), state.frame.end(), work.begin());
+    std::fill(work.begin() + fftSize, work.end(), 0.0f);
+    fft->performRealOnlyForwardTransform(work.data(), true);
+
+    auto *delayLine = state.delayLine.data();
+    std::copy_n(work.begin(), spectrumSize,
+                delayLine + state.position * spectrumSize);
+
+    std::fill(work.begin(), work.end(), 0.0f);
+
+    for (int k = 0, slot = state.position; k < numPartitions; ++k) {
+      multiplyAdd(work.data(), delayLine + slot * spectrumSize,
+                  state.partitions + k * spectrumSize, blockSize + 1);
+      slot = (slot == 0 ? numPartitions : slot) - 1;
+    }
+
+    state.position = (state.position + 1) % numPartitions;
+
+    // The second half of the frame is free of circular wrap-around
+    fft->performRealOnlyInverseTransform(work.data());
+    std::copy_n(work.begin() + blockSize, blockSize, output);
+  }
+
+private:
+  int blockSize = 0, fftSize = 0, spectrumSize = 0, numPartitions = 0;
+  std::unique_ptr<juce::dsp::FFT> fft;
+
+  // Partition spectra per IR channel
+  std::vector<std::vector<float>> partitions;
+
+  struct Channel {
+    std::vector<float> frame, delayLine;
+    const float *partitions = nullptr;
+    int position = 0; // Delay line slot of the newest spectrum
+  };
+
+  std::vector<Channel> channels;
+  std::vector<float> work; // FFT in place (2 x fftSize)
+};
+} // namespace
+
+//==============================================================================
+// Wakes the worker. An OS semaphore rather than juce::WaitableEvent, whose
+// signal() takes a mutex: posting one is a single atomic operation (plus a
+// system call only when the worker is waiting), so the audio thread can do
+// it.
+class CabinetConvolver::WorkerSignal {
+public:
+#if JUCE_WINDOWS
+  WorkerSignal() : semaphore(CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr)) {}
+  ~WorkerSignal() { CloseHandle(semaphore); }
+  void signal() { ReleaseSemaphore(semaphore, 1, nullptr); }
+  void wait() { WaitForSingleObject(semaphore, INFINITE); }
+
+private:
+  HANDLE semaphore;
+#elif JUCE_MAC || JUCE_IOS
+  WorkerSignal() : semaphore(dispatch_semaphore_create(0)) {}
+  ~WorkerSignal() { dispatch_release(semaphore); }
+  void signal() { dispatch_semaphore_signal(semaphore); }
+  void wait() { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+
+private:
+  dispatch_semaphore_t semaphore;
+#else
+  WorkerSignal() { sem_init(&semaphore, 0, 0); }
+  ~WorkerSignal() { sem_destroy(&semaphore); }
+  void signal() { sem_post(&semaphore); }
+
+  void wait() {
+    while (sem_wait(&semaphore) != 0 && errno == EINTR) {
+    }
+  }
+
+private:
+  sem_t semaphore;
+#endif
+};
+
+//==============================================================================
+// One IR prepared for one session: kernels plus all convolution state. Built
+// off the audio thread, then owned by it.
+struct CabinetConvolver::Convolution {
+  Convolution(const juce::AudioBuffer<float> &impulseResponse, double sampleRate,
+              int numChannelsToUse, std::atomic<juce::int64> &lateTailBlocks)
+      : length(numChannelsToUse > 0 ? impulseResponse.getNumSamples() : 0),
+        numChannels(numChannelsToUse), numLateTailBlocks(lateTailBlocks) {
+    if (length == 0)
+      return;
+
+    tailBlockSize = juce::jmax(
+        2 * headLength,
+        juce::nextPowerOfTwo(juce::roundToInt(sampleRate * tailBlockSeconds)));
+
+    numHeadTaps = juce::jmin(headLength, length);
+
+    for (int irChannel = 0; irChannel < impulseResponse.getNumChannels();
+         ++irChannel) {
+      const auto *taps = impulseResponse.getReadPointer(irChannel);
+      headTaps.emplace_back(taps, taps + numHeadTaps);
+    }
+
+    body.prepare(impulseResponse, headLength, 2 * tailBlockSize, headLength,
+                 numChannels);
+    tail.prepare(impulseResponse, 2 * tailBlockSize, length, tailBlockSize,
+                 numChannels);
+
+    auto perChannel = [this](int size) {
+      return std::vector<std::vector<float>>(
+          static_cast<size_t>(numChannels),
+          std::vector<float>(static_cast<size_t>(size), 0.0f));
+    };
+
+    headInput = perChannel(2 * headLength);
+    headOutput.assign(static_cast<size_t>(headLength), 0.0f);
+    bodyOutput = perChannel(headLength);
+    tailInput = perChannel(tailBlockSize);
+
+    for (auto &slot : tailSlots) {
+      slot.input = perChannel(tailBlockSize);
+      slot.output = perChannel(tailBlockSize);
+    }
+  }
+
+  bool isEmpty() const { return length == 0; }
+  bool hasTail() const { return tail.getNumPartitions() > 0; }
+
+  // Samples until the next body (and head input) block boundary
+  int getSamplesToBoundary() const { return headLength - bodyPosition; }
+
+  // Runs the oldest queued tail block, if any. Worker thread, or the audio
+  // thread when rendering offline; returns false if the other one is running
+  // a block (the tail stage takes them one at a time, in order).
+  bool runNextTail() {
+    if (tailBusy.exchange(true, std::memory_order_acquire))
+      return false;
+
+    TailSlot *next = nullptr;
+
+    for (auto &slot : tailSlots)
+      if (slot.state.load(std::memory_order_acquire) == queued &&
+          (next == nullptr || slot.sequence < next->sequence))
+        next = &slot;
+
+    if (next == nullptr) {
+      tailBusy.store(false, std::memory_order_release);
+      return false;
+    }
+
+    next->state.store(running, std::memory_order_relaxed);
+
+    // The first block after a reset() starts the tail from silence
+    if (next->resetFirst)
+      tail.reset();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+      tail.process(channel, next->input[static_cast<size_t>(channel)].data(),
+                   next->output[static_cast<size_t>(channel)].data());
+
+    next->state.store(done, std::memory_order_release);
+    tailBusy.store(false, std::memory_order_release);
+    return true;
+  }
+
+  // Audio thread: back to silence (does not allocate or wait). Tail blocks
+  // still in flight are dropped as they finish, and the worker clears the
+  // tail stage before the next one.
+  void reset() {
+    if (clean)
+      return;
+
+    for (auto *buffers : {&headInput, &bodyOutput, &tailInput})
+      for (auto &buffer : *buffers)
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+
+    body.reset();
+    bodyPosition = tailPosition = 0;
+    playingSlot = queuedSlot = -1;
+    tailResetPending = true;
+    clean = true;
+  }
+
+  // Audio thread: at most getSamplesToBoundary() samples, starting at
+  // startSample. Output = dry + wet * (convolved - dry). Returns true if a
+  // tail block was queued for the worker.
+  template <typename SampleType>
+  bool process(SampleType *const *channels, int numChannelsToProcess,
+               int startSample, int numSamples, const float *wetGains,
+               bool realtime) {
+    auto *y = headOutput.data();
+
+    for (int channel = 0; channel < numChannelsToProcess; ++channel) {
+      const auto c = static_cast<size_t>(channel);
+      auto *data = channels[channel] + startSample;
+      auto *input = headInput[c].data() + headLength + bodyPosition;
+      auto *tailIn = tailInput[c].data() + tailPosition;
+
+      for (int i = 0; i < numSamples; ++i)
+        input[i] = tailIn[i] = static_cast<float>(data[i]);
+
+      // Body and tail output (a late tail block is silent), then the head
+      // taps as a block FIR, one vector pass per tap; the previous block
+      // sits right before the input
+      if (playingSlot >= 0)
+        juce::FloatVectorOperations::add(
+            y, bodyOutput[c].data() + bodyPosition,
+            tailSlots[static_cast<size_t>(playingSlot)].output[c].data() +
+                tailPosition,
+            numSamples);
+      else
+        juce::FloatVectorOperations::copy(
+            y, bodyOutput[c].data() + bodyPosition, numSamples);
+
+      const auto &taps = headTaps[c % headTaps.size()];
+
+      for (int k = 0; k < numHeadTaps; ++k)
+        juce::FloatVectorOperations::addWithMultiply(
+            y, input - k, taps[static_cast<size_t>(k)], numSamples);
+
+      for (int i = 0; i < numSamples; ++i)
+        data[i] = static_cast<SampleType>(input[i] +
+                                          wetGains[i] * (y[i] - input[i]));
+    }
+
+    clean = false;
+    bodyPosition += numSamples;
+    tailPosition += numSamples;
+
+    if (bodyPosition == headLength) {
+      bodyPosition = 0;
+
+      for (int channel = 0; channel < numChannels; ++channel) {
+        auto &block = headInput[static_cast<size_t>(channel)];
+
+        if (body.getNumPartitions() > 0)
+          body.process(channel, block.data() + headLength,
+                       bodyOutput[static_cast<size_t>(channel)].data());
+
+        std::copy_n(block.begin() + headLength, headLength, block.begin());
+      }
+    }
+
+    if (tailPosition == tailBlockSize) {
+      tailPosition = 0;
+
+      if (hasTail())
+        return queueTail(realtime);
+    }
+
+    return false;
+  }
+
+  // Audio thread, at a tail block boundary: the block queued one boundary
+  // ago becomes the output if the worker has finished it, and the block just
+  // collected is queued. Never waits in real time: a late block leaves the
+  // tail silent for one block, and a block that finds no free slot is
+  // dropped; both are counted. Offline, late blocks are completed here.
+  bool queueTail(bool realtime) {
+    auto next = -1;
+
+    if (queuedSlot >= 0) {
+      auto &slot = tailSlots[static_cast<size_t>(queuedSlot)];
+
+      if (!realtime)
+        while (slot.state.load(std::memory_order_acquire) != done)
+          if (!runNextTail())
+            juce::Thread::yield();
+
+      if (slot.state.load(std::memory_order_acquire) == done)
+        next = queuedSlot;
+      else
+        numLateTailBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The block that just played and any late ones finished since are free
+    for (size_t i = 0; i < tailSlots.size(); ++i)
+      if (static_cast<int>(i) != next &&
+          tailSlots[i].state.load(std::memory_order_acquire) == done)
+        tailSlots[i].state.store(empty, std::memory_order_relaxed);
+
+    playingSlot = next;
+    auto &slot = tailSlots[static_cast<size_t>(nextSlot)];
+
+    if (slot.state.load(std::memory_order_acquire) != empty) {
+      queuedSlot = -1;
+      numLateTailBlocks.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    std::swap(slot.input, tailInput);
+    slot.sequence = ++tailSequence;
+    slot.resetFirst = std::exchange(tailResetPending, false);
+    slot.state.store(queued, std::memory_order_release);
+
+    queuedSlot = nextSlot;
+    nextSlot = (nextSlot + 1) % static_cast<int>(tailSlots.size());
+    return true;
+  }
+
+  enum TailState { empty, queued, running, done };
+
+  // One tail block in flight. The audio thread owns an empty slot and the
+  // one it plays (done); runNextTail() owns it while queued or running.
+  struct TailSlot {
+    std::vector<std::vector<float>> input, output; // Per channel
+    juce::int64 sequence = 0; // Queue order
+    bool resetFirst = false;  // Clear the tail stage before this block
+    std::atomic<int> state{empty};
+  };
+
+  const int length;
+  const int numChannels;
+  int tailBlockSize = 0;
+
+  std::vector<std::vector<float>> headTaps; // Per IR channel
+  int numHeadTaps = 0;
+  PartitionedStage body, tail;
+
+  // Per channel. headInput holds the previous head block, then the current
+  // one (which the body takes at the boundary).
+  std::vector<std::vector<float>> headInput, bodyOutput;
+  std::vector<std::vector<float>> tailInput; // Block being collected
+
+  // The block playing, the one the worker is computing, and one spare for
+  // the next boundary while a late block is still running
+  std::array<TailSlot, 3> tailSlots;
+
+  std::vector<float> headOutput; // Chunk scratch
+
+  int bodyPosition = 0, tailPosition = 0;
+  int playingSlot = -1, queuedSlot = -1, nextSlot = 0; // -1 = none
+  juce::int64 tailSequence = 0;
+  bool tailResetPending = false, clean = true;
+  std::atomic<bool> tailBusy{false}; // A tail block is being computed
+  std::atomic<juce::int64> &numLateTailBlocks;
+};
+
+//==============================================================================
+CabinetConvolver::CabinetConvolver()
+    : juce::Thread("Fuzza cabinet tail"),
+      workerSignal(std::make_unique<WorkerSignal>()) {}
+
+CabinetConvolver::~CabinetConvolver() {
+  stopWorker();
+  delete pending.exchange(nullptr);
+  delete active.exchange(nullptr);
+  delete retired.exchange(nullptr);
+}
+
+void CabinetConvolver::prepare(double newSampleRate, int newNumChannels) {
+  stopWorker();
+  delete pending.exchange(nullptr);
+  delete active.exchange(nullptr);
+  delete retired.exchange(nullptr);
+
+  sampleRate = newSampleRate;
+  numChannels = newNumChannels;
+
+  wet.reset(sampleRate, fadeSeconds);
+  wet.setCurrentAndTargetValue(0.0f);
+  wetGains.assign(static_cast<size_t>(headLength), 0.0f);
+
+  active.store(build());
+
+  // Started here, on the thread that prepares, and never by publish(), so
+  // two threads setting an IR cannot both start it. Without an IR it sleeps
+  // on its signal until the audio thread retires something.
+  startThread(juce::Thread::Priority::high);
+}
+
+void CabinetConvolver::setImpulseResponse(
+    const juce::AudioBuffer<float> &impulseResponse,
+    double impulseResponseRate) {
+  {
+    const juce::ScopedLock lock(sourceLock);
+    source.makeCopyOf(impulseResponse);
+    sourceRate = impulseResponseRate;
+  }
+
+  // Not prepared yet: prepare() builds it
+  if (sampleRate <= 0.0)
+    return;
+
+  publish(build());
+}
+
+CabinetConvolver::Convolution *CabinetConvolver::build() {
+  juce::AudioBuffer<float> impulseResponse;
+
+  {
+    const juce::ScopedLock lock(sourceLock);
+
+    if (source.getNumSamples() > 0 && sourceRate > 0.0)
+      impulseResponse =
+          resample(source, sourceRate, sampleRate,
+                   juce::roundToInt(sampleRate * maxImpulseSeconds));
+  }
+
+  normalise(impulseResponse);
+  tailSeconds.store(impulseResponse.getNumSamples() / sampleRate);
+
+  return new Convolution(impulseResponse, sampleRate, numChannels,
+                         numLateTailBlocks);
+}
+
+void CabinetConvolver::publish(Convolution *convolution) {
+  // Only enqueues: the worker has been running since prepare(). Replaces a
+  // convolution the audio thread has not taken yet.
+  delete pending.exchange(convolution, std::memory_order_acq_rel);
+}
+
+void CabinetConvolver::stopWorker() {
+  signalThreadShouldExit();
+  workerSignal->signal();
+  stopThread(1000);
+}
+
+void CabinetConvolver::run() {
+  while (!threadShouldExit()) {
+    delete retired.exchange(nullptr, std::memory_order_acquire);
+
+    auto *convolution = active.load(std::memory_order_acquire);
+
+    if (convolution != nullptr)
+      while (convolution->runNextTail()) {
+      }
+
+    // Sleeps until the audio thread queues or retires something
+    workerSignal->wait();
+  }
+}
+
+template <typename SampleType>
+void CabinetConvolver::process(juce::AudioBuffer<SampleType> &buffer,
+                               int numChannelsToProcess, bool enabled,
+                               bool realtime) {
+  auto *convolution = active.load(std::memory_order_relaxed);
+  const auto hasPending = pending.load(std::memory_order_relaxed) != nullptr;
+
+  if (wet.getCurrentValue() == 0.0f && !wet.isSmoothing()) {
+    // Faded out: the moment to take a new IR. The old one goes to the
+    // worker to be freed once it is no longer active (the worker may still
+    // be running one of its tail blocks, and frees it after that); the swap
+    // waits if it has not freed the last one.
+    if (hasPending && retired.load(std::memory_order_acquire) == nullptr) {
+      auto *next = pending.exchange(nullptr, std::memory_order_acquire);
+
+      active.store(next, std::memory_order_release);
+      retired.store(convolution, std::memory_order_release);
+      workerSignal->signal();
+      convolution = next;
+    }
+
+    if (!enabled || convolution == nullptr || convolution->isEmpty() ||
+        pending.load(std::memory_order_relaxed) != nullptr)
+      return;
+
+    // Fade in from silence, not from whatever was playing when it faded out
+    convolution->reset();
+    wet.setTargetValue(1.0f);
+  } else {
+    wet.setTargetValue(enabled && !hasPending ? 1.0f : 0.0f);
+  }
+
+  numChannelsToProcess =
+      juce::jmin(numChannelsToProcess, buffer.getNumChannels(),
+                 convolution->numChannels);
+  auto *const *channels = buffer.getArrayOfWritePointers();
+  const auto numSamples = buffer.getNumSamples();
+
+  for (int start = 0; start < numSamples;) {
+    const auto chunk =
+        juce::jmin(numSamples - start, convolution->getSamplesToBoundary());
+
+    for (int i = 0; i < chunk; ++i)
+      wetGains[static_cast<size_t>(i)] = wet.getNextValue();
+
+    if (convolution->process(channels, numChannelsToProcess, start, chunk,
+                             wetGains.data(), realtime))
+      workerSignal->signal();
+
+    start += chunk;
+  }
+}
+
+template void CabinetConvolver::process<float>(juce::AudioBuffer<float> &, int,
+                                               bool, bool);
+template void CabinetConvolver::process<double>(juce::AudioBuffer<double> &,
+                                                int, bool, bool);
+
+} // namespace fuzza
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace fuzza {
+
+// Cabinet impulse response stage: non-uniform partitioned convolution with
+// no latency and an audio-thread cost that does not grow with the IR.
+//
+// The IR is split into three segments, each convolved on its own:
+//
+//   head  [0, P)     direct-form FIR, sample by sample (P = headLength)
+//   body  [P, 2L)    uniform partitioned FFT convolution, block P, on the
+//                    audio thread
+//   tail  [2L, end)  uniform partitioned FFT convolution, block L (about
+//                    10 ms), on a worker thread
+//
+// Every segment starts one block of its own size after the previous one
+// ends, so its next output block only needs input that has already
+// arrived. A tail block is due one block after its input is complete, which
+// gives the worker a whole block period to compute it. The audio thread
+// signals the worker through a semaphore and never waits for it or computes
+// a tail block itself: if the worker is late (a starved thread), the tail is
+// silent for that block and the miss is counted. Offline renders, which run
+// faster than real time, complete late blocks on the calling thread so the
+// result matches real-time playback.
+//
+// IRs are resampled to the session rate, normalised to unit energy and cut
+// at maxImpulseSeconds. Channel c uses IR channel c % (IR channels).
+// Processing is in float, whatever the sample type.
+class CabinetConvolver : private juce::Thread {
+public:
+  static constexpr int headLength = 64;
+  static constexpr double maxImpulseSeconds = 2.0;
+  static constexpr double fadeSeconds = 0.01;
+
+  CabinetConvolver();
+  ~CabinetConvolver() override;
+
+  // Rebuilds the IR for the session rate and channel count and (re)starts
+  // the worker; may allocate. The audio thread must not be running.
+  void prepare(double sampleRate, int numChannels);
+
+  // Message thread. Prepares the IR for the current session and hands it to
+  // the audio thread, which fades out the old one and in the new one. An
+  // empty buffer removes the IR.
+  void setImpulseResponse(const juce::AudioBuffer<float> &impulseResponse,
+                          double impulseResponseRate);
+
+  // Length of the IR at the session rate
+  double getTailLengthSeconds() const { return tailSeconds.load(); }
+
+  // Tail blocks the worker did not deliver in time since construction (any
+  // thread)
+  juce::int64 getNumLateTailBlocks() const { return numLateTailBlocks.load(); }
+
+  // Audio thread. Convolves the first numChannels channels in place. While
+  // disabled (or without an IR) the signal passes untouched, with a short
+  // crossfade at either change. realtime = false (offline rendering) lets it
+  // wait for the worker instead of dropping late tail blocks.
+  template <typename SampleType>
+  void process(juce::AudioBuffer<SampleType> &buffer, int numChannels,
+               bool enabled, bool realtime);
+
+private:
+  struct Convolution;
+  class WorkerSignal;
+
+  // Worker: runs queued tail blocks and frees convolutions the audio thread
+  // has retired, sleeping on workerSignal in between
+  void run() override;
+  void stopWorker();
+
+  Convolution *build();
+  void publish(Convolution *convolution);
+
+  // The IR as loaded, kept to rebuild it when the session rate changes
+  juce::CriticalSection sourceLock;
+  juce::AudioBuffer<float> source;
+  double sourceRate = 0.0;
+
+  double sampleRate = 0.0;
+  int numChannels = 0;
+  std::atomic<double> tailSeconds{0.0};
+
+  // Message thread -> audio thread -> worker. Only the audio thread changes
+  // active; only the worker deletes what the audio thread retires.
+  std::atomic<Convolution *> pending{nullptr};
+  std::atomic<Convolution *> active{nullptr};
+  std::atomic<Convolution *> retired{nullptr};
+
+  std::unique_ptr<WorkerSignal> workerSignal;
+  std::atomic<juce::int64> numLateTailBlocks{0};
+
+  // Crossfade between the dry and the convolved signal
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> wet;
+  std::vector<float> wetGains;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CabinetConvolver)
+};
+
+} // namespace fuzza
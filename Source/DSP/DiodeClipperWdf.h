@@ -0,0 +1,180 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <cmath>
+#include <vector>
+
+#include "Waveshapers.h"
+
+namespace fuzza {
+
+// Wave digital filter model of the clipping stage of a Big Muff Pi: the
+// driven signal through a series resistor into a capacitor in parallel with
+// an antiparallel pair of 1N914 silicon diodes (the gain stage before it is
+// GAIN).
+//
+//   Vin --[ R ]---+-------+-------+
+//                 |       |       |
+//                 C      D1 v    D2 ^
+//                 |       |       |
+//   GND ----------+-------+-------+
+//
+// WDF tree: the resistive voltage source (Vin, R) and the capacitor
+// (bilinear, port resistance T / 2C) on a parallel adaptor, with the diode
+// pair as the nonlinear root. One sample is
+//
+//   a = g Vin + (1 - g) z      wave into the root, g = R_C / (R + R_C)
+//   v = solve(a)               v + 2 Is Rp sinh(v / n Vt) = a
+//   z = 2 v - z                capacitor state
+//
+// and the output is the diode voltage v, scaled so the small-signal gain is
+// 1 / outputVolts.
+//
+// The diode equation is implicit, but it only depends on the sample rate
+// (through the parallel port resistance Rp), so its solution v(a) is
+// tabulated once per rate and shared by every engine through
+// SharedResources. Per sample that leaves a division, a table read and a
+// linear interpolation (max error 1e-5 V over the whole range). At High
+// precision one Newton step, started from the table value, polishes v to
+// within float rounding: a fixed iteration count with a warm start, never an
+// open-ended loop.
+//
+//   Eco, Standard   table, max error 1.4e-5 V   ~25 ns/sample per channel
+//   High            table + one Newton step,
+//                   max error 1.7e-7 V          ~60 ns/sample per channel
+//
+// (x86-64, the machine of the figures in Waveshapers.h. The capacitor makes
+// every sample depend on the last, so the loop is latency bound rather than
+// vectorised.)
+//
+// v is odd in a, so the table covers a >= 0 at positions
+// u = a / (a + kneeVolts), dense around the diode knee and still finite at
+// the largest drive.
+template <typename SampleType> class DiodeClipperWdf {
+public:
+  static constexpr int numPoints = 2048;
+
+  // Component values
+  static constexpr double resistance = 2200.0;        // R (ohms)
+  static constexpr double capacitance = 10.0e-9;      // C (farads)
+  static constexpr double saturationCurrent = 2.52e-9; // Is (amperes)
+  static constexpr double thermalVoltage = 0.02585 * 1.752; // n Vt (volts)
+
+  // Clipper input and output in volts per unit of signal: the diodes settle
+  // around 0.7 V, which comes out as roughly +-1
+  static constexpr double outputVolts = 0.7;
+
+  // Allocates; call from prepare(). The rate is the one the clipper runs at
+  // (oversampled, if it is).
+  void prepare(double sampleRate) {
+    const auto capacitorResistance = 1.0 / (2.0 * capacitance * sampleRate);
+    parallelResistance = resistance * capacitorResistance /
+                         (resistance + capacitorResistance);
+    sourceWeight = static_cast<SampleType>(capacitorResistance /
+                                           (resistance + capacitorResistance));
+    diodeScale = 2.0 * saturationCurrent * parallelResistance;
+
+    table.resize(numPoints + 1); // Guard point for position == last
+
+    for (int i = 0; i <= numPoints; ++i) {
+      auto u = juce::jmin(i, numPoints - 1) * maximumPosition / (numPoints - 1);
+      table[static_cast<size_t>(i)] =
+          static_cast<SampleType>(solve(kneeVolts * u / (1.0 - u)));
+    }
+
+    newtonScale = static_cast<SampleType>(diodeScale);
+    inverseThermalVoltage = static_cast<SampleType>(1.0 / thermalVoltage);
+  }
+
+  // Runs the circuit over a block in place; state is the capacitor's wave
+  // (zero at rest)
+  template <waveshaper::Precision precision>
+  void process(SampleType *data, int numSamples, SampleType &state) const {
+    const auto inputScale = sourceWeight;
+    const auto stateScale = SampleType(1) - sourceWeight;
+    const auto outputScale = static_cast<SampleType>(1.0 / outputVolts);
+    const auto knee = static_cast<SampleType>(kneeVolts);
+    const auto pointsPerPosition =
+        static_cast<SampleType>((numPoints - 1) / maximumPosition);
+    const auto lastPosition = static_cast<SampleType>(numPoints - 1);
+    auto z = state;
+
+    for (int sample = 0; sample < numSamples; ++sample) {
+      const auto a = inputScale * data[sample] + stateScale * z;
+      const auto magnitude = std::abs(a);
+
+      auto position = juce::jmin(
+          lastPosition, magnitude / (magnitude + knee) * pointsPerPosition);
+      auto index = static_cast<int>(position);
+      auto fraction = position - static_cast<SampleType>(index);
+      auto lower = table[static_cast<size_t>(index)];
+      auto v = lower + fraction * (table[static_cast<size_t>(index) + 1] - lower);
+
+      if constexpr (precision == waveshaper::Precision::high) {
+        // f(v) = v + k sinh(v / nVt) - |a|, one step
+        const auto e = std::exp(v * inverseThermalVoltage);
+        const auto inverse = SampleType(1) / e;
+        const auto f = v + newtonScale * SampleType(0.5) * (e - inverse) -
+                       magnitude;
+        const auto slope = SampleType(1) + newtonScale * SampleType(0.5) *
+                                               inverseThermalVoltage *
+                                               (e + inverse);
+        v -= f / slope;
+      }
+
+      v = a < 0 ? -v : v;
+      z = SampleType(2) * v - z;
+      data[sample] = v * outputScale;
+    }
+
+    state = z;
+  }
+
+  size_t getSizeInBytes() const {
+    return sizeof(*this) + table.capacity() * sizeof(SampleType);
+  }
+
+private:
+  // Table positions: u = a / (a + kneeVolts) up to maximumPosition, i.e.
+  // a up to 999 kneeVolts
+  static constexpr double kneeVolts = 1.0;
+  static constexpr double maximumPosition = 0.999;
+
+  // v for a >= 0 to double precision (build time only). Newton on the
+  // log form v - nVt asinh((a - v) / k) = 0, which stays well conditioned
+  // however hard the diodes conduct, kept inside the bracket [0, a].
+  double solve(double a) const {
+    double low = 0.0, high = a, v = 0.5 * a;
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+      const auto current = (a - v) / diodeScale;
+      const auto f = v - thermalVoltage * std::asinh(current);
+
+      if (f > 0.0)
+        high = v;
+      else
+        low = v;
+
+      const auto slope =
+          1.0 + thermalVoltage / (diodeScale * std::sqrt(current * current + 1.0));
+      auto next = v - f / slope;
+
+      if (!(next >= low && next <= high))
+        next = 0.5 * (low + high);
+
+      if (std::abs(next - v) <= 1.0e-15 * juce::jmax(1.0, a))
+        return next;
+
+      v = next;
+    }
+
+    return v;
+  }
+
+  double parallelResistance = 1.0, diodeScale = 0.0;
+  SampleType sourceWeight = 1, newtonScale = 0, inverseThermalVoltage = 1;
+  std::vector<SampleType> table;
+};
+
+} // namespace fuzza
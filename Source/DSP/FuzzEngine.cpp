@@ -0,0 +1,1496 @@
+#include "FuzzEngine.h"
+
+namespace fuzza {
+
+namespace {
+// Gate Parameters
+const float inputAttack = 0.005f;  // 5ms
+const float inputRelease = 0.05f;  // 50ms
+const float outputAttack = 0.02f;  // 20ms
+const float outputRelease = 0.5f;  // 500ms
+
+// Gate decisions (open, close, hold) are made once per segment of this length
+const float gateIntervalSeconds = 0.00025f; // 0.25ms
+
+// Tone cutoff glide time
+const float toneGlideSeconds = 0.05f; // 50ms
+
+// Multiband runs its passes (crossovers, curves, lane sum) over chunks of
+// this many samples, small enough to stay in L1
+const int bandChunkSize = 64;
+
+// Blocks whose output could not exceed this are silent (-120 dBFS)
+const float silenceFloor = 1.0e-6f;
+
+template <typename SampleType>
+SampleType makeGateCoefficient(double sampleRate, float timeSeconds) {
+  return static_cast<SampleType>(std::exp(-1.0 / (sampleRate * timeSeconds)));
+}
+
+template <typename Lanes> Lanes absLanes(Lanes x) {
+  return Lanes::max(x, Lanes::expand(0) - x);
+}
+
+int getNumGroups(int numChannels, int lanesPerGroup) {
+  return (numChannels + lanesPerGroup - 1) / lanesPerGroup;
+}
+} // namespace
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::ChannelState::resize(int numGroups) {
+  for (auto *lanes : {&toneS1, &toneS2})
+    lanes->resize(static_cast<size_t>(numGroups));
+
+  for (auto *gates : {&inputGate, &outputGate})
+    gates->resize(static_cast<size_t>(numGroups));
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::ChannelState::reset() {
+  for (auto *lanes : {&toneS1, &toneS2})
+    std::fill(lanes->begin(), lanes->end(), Lanes::expand(0));
+
+  // Closed, as after a long silence
+  const auto zero = Lanes::expand(0);
+
+  for (auto *gates : {&inputGate, &outputGate})
+    std::fill(gates->begin(), gates->end(), GateLanes{zero, zero, zero});
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::prepare(double newSampleRate,
+                                     int newMaximumBlockSize, int numChannels) {
+  sampleRate = newSampleRate;
+  maximumBlockSize = juce::jmax(1, newMaximumBlockSize);
+
+  jassert(numChannels <= maxChannels);
+  preparedChannels = juce::jlimit(1, maxChannels, numChannels);
+  numGroups = getNumGroups(preparedChannels, lanesPerGroup);
+
+  gateInterval =
+      juce::jmax(1, juce::roundToInt(sampleRate * gateIntervalSeconds));
+
+  // Gain ramp positions 1..gateInterval, so every sample of a segment gets
+  // its gain without a running sum
+  gateRamp.resize(static_cast<size_t>(gateInterval));
+  const auto maximumSegments =
+      static_cast<size_t>((maximumBlockSize + gateInterval - 1) / gateInterval);
+  gateCounts.resize(maximumSegments);
+  gateSegments.resize(maximumSegments);
+
+  for (size_t sample = 0; sample < gateRamp.size(); ++sample)
+    gateRamp[sample] = Lanes::expand(static_cast<SampleType>(sample + 1));
+
+  auto makeGateCoefficients = [this](float attack, float release) {
+    return GateCoefficients{
+        makeGateCoefficient<SampleType>(sampleRate, release),
+        static_cast<SampleType>(-1.0 / (sampleRate * attack)),
+        static_cast<SampleType>(-1.0 / (sampleRate * release))};
+  };
+
+  inputGateCoefficients = makeGateCoefficients(inputAttack, inputRelease);
+  outputGateCoefficients = makeGateCoefficients(outputAttack, outputRelease);
+
+  state.resize(numGroups);
+
+  // The dry path is needed until the mix, so it keeps a block per group
+  dryLanes.resize(static_cast<size_t>(numGroups * maximumBlockSize));
+  wetLanes.resize(static_cast<size_t>(maximumBlockSize));
+
+  // Cascaded half-band polyphase IIR stages with integer latency, so the dry
+  // path and the host's delay compensation can be matched exactly
+  int maximumLatency = 0;
+
+  for (size_t i = 0; i < oversamplers.size(); ++i) {
+    oversamplers[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+        static_cast<size_t>(preparedChannels), i + 1,
+        juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true,
+        true);
+    oversamplers[i]->initProcessing(static_cast<size_t>(maximumBlockSize));
+    maximumLatency =
+        juce::jmax(maximumLatency, getLatencySamples(static_cast<int>(i) + 1));
+  }
+
+  dryDelayLength = maximumLatency + 1;
+  dryDelayLine.resize(static_cast<size_t>(numGroups * dryDelayLength));
+  outputDelayLine.resize(
+      static_cast<size_t>(preparedChannels * dryDelayLength));
+
+  antialiasingState.resize(static_cast<size_t>(preparedChannels));
+  waveshaper::TanhAntiderivatives::initialise();
+
+  circuitState.resize(static_cast<size_t>(preparedChannels));
+
+  for (size_t i = 0; i < circuits.size(); ++i) {
+    const auto rate = sampleRate * static_cast<double>(1 << i);
+    circuits[i] = SharedResources::get<DiodeClipperWdf<SampleType>>(
+        "diodeClipper/" + juce::String(rate), [rate] {
+          DiodeClipperWdf<SampleType> circuit;
+          circuit.prepare(rate);
+          return circuit;
+        });
+  }
+
+  bandS1.resize(static_cast<size_t>(preparedChannels));
+  bandS2.resize(static_cast<size_t>(preparedChannels));
+  bandRate = 0.0;
+
+  toneTable = SharedResources::get<SvfCoefficientTable<SampleType>>(
+      "tone/" + juce::String(sampleRate), [this] {
+        SvfCoefficientTable<SampleType> table;
+        table.prepare(sampleRate, minimumToneFrequency, maximumToneFrequency);
+        return table;
+      });
+  toneRampLength = juce::jmax(1, juce::roundToInt(sampleRate * toneGlideSeconds));
+  toneRampG.resize(static_cast<size_t>(maximumBlockSize));
+  toneRampH.resize(static_cast<size_t>(maximumBlockSize));
+  reset();
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::reset() {
+  state.reset();
+  std::fill(antialiasingState.begin(), antialiasingState.end(),
+            waveshaper::AntialiasingState());
+  std::fill(circuitState.begin(), circuitState.end(), SampleType(0));
+
+  for (auto &oversampler : oversamplers)
+    if (oversampler != nullptr)
+      oversampler->reset();
+
+  std::fill(dryDelayLine.begin(), dryDelayLine.end(), Lanes::expand(0));
+  dryDelayPosition = 0;
+  resetBands();
+
+  std::fill(outputDelayLine.begin(), outputDelayLine.end(), SampleType(0));
+  outputDelayPosition = 0;
+
+  // Jump straight to the next block's cutoff
+  toneFrequency = -1.0f;
+  toneTarget = -1.0f;
+  toneRampSamples = 0;
+
+  silentSamples = 0;
+  sleptSamples = 0;
+  sleeping = false;
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::continueFrom(const FuzzEngine &other) {
+  jassert(other.sampleRate == sampleRate && other.numGroups == numGroups);
+
+  // A sleeping engine's gates have not been advanced over the silence; after
+  // a reset() ours (closed, filter at rest) are the right state instead
+  if (!other.sleeping) {
+    std::copy(other.state.toneS1.begin(), other.state.toneS1.end(),
+              state.toneS1.begin());
+    std::copy(other.state.toneS2.begin(), other.state.toneS2.end(),
+              state.toneS2.begin());
+    std::copy(other.state.inputGate.begin(), other.state.inputGate.end(),
+              state.inputGate.begin());
+    std::copy(other.state.outputGate.begin(), other.state.outputGate.end(),
+              state.outputGate.begin());
+  }
+
+  toneFrequency = other.toneFrequency;
+  toneG = other.toneG;
+  toneR2 = other.toneR2;
+  toneH = other.toneH;
+  toneTarget = other.toneTarget;
+  tonePosition = other.tonePosition;
+  toneTargetPosition = other.toneTargetPosition;
+  toneStep = other.toneStep;
+  toneRampSamples = other.toneRampSamples;
+}
+
+double FuzzEngineBase::getTailLengthSeconds() {
+  return static_cast<double>(outputRelease);
+}
+
+template <typename SampleType>
+int FuzzEngine<SampleType>::getLatencySamples(int oversampling) const {
+  if (oversampling <= 0 || oversampling >= numOversamplingFactors)
+    return 0;
+
+  auto &oversampler = oversamplers[static_cast<size_t>(oversampling - 1)];
+
+  if (oversampler == nullptr)
+    return 0;
+
+  return juce::roundToInt(oversampler->getLatencyInSamples());
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::process(juce::AudioBuffer<SampleType> &buffer,
+                                     int numChannels,
+                                     const Parameters &params) {
+  jassert(numChannels <= preparedChannels);
+  numChannels =
+      juce::jmin(numChannels, preparedChannels, buffer.getNumChannels());
+
+  activeChannels = juce::jmax(0, numChannels);
+  clippedSamples = 0;
+
+  if (numChannels <= 0 || maximumBlockSize == 0)
+    return;
+
+  // A new cutoff starts a glide; the tan() only runs once it settles
+  if (params.toneFrequency != toneTarget)
+    setToneTarget(params.toneFrequency);
+
+  // Switching factor: start the new filter chain and the dry delay from rest
+  auto oversampling =
+      juce::jlimit(0, numOversamplingFactors - 1, params.oversampling);
+
+  if (oversampling != activeOversampling) {
+    activeOversampling = oversampling;
+
+    if (oversampling > 0)
+      oversamplers[static_cast<size_t>(oversampling - 1)]->reset();
+
+    std::fill(dryDelayLine.begin(), dryDelayLine.end(), Lanes::expand(0));
+    dryDelayPosition = 0;
+    std::fill(antialiasingState.begin(), antialiasingState.end(),
+              waveshaper::AntialiasingState());
+    std::fill(circuitState.begin(), circuitState.end(), SampleType(0));
+    resetBands();
+  }
+
+  // The history is only kept while anti-aliasing runs, so turning it on
+  // starts from rest too
+  if (params.antialiasing != activeAntialiasing) {
+    activeAntialiasing = params.antialiasing;
+    std::fill(antialiasingState.begin(), antialiasingState.end(),
+              waveshaper::AntialiasingState());
+  }
+
+  updateBands(params);
+
+  // GATE at 0% bypasses both gate stages. Hold them open so turning the gate
+  // on starts from unity gain instead of fading in.
+  const auto gateEnabled = params.gateThreshold > 0.0f;
+
+  if (!gateEnabled)
+    holdGatesOpen();
+
+  // Sleep once the tail of the last non-silent block has fully decayed
+  if (isSilent(buffer, numChannels, params)) {
+    const auto tailSamples =
+        juce::roundToInt(getTailLengthSeconds() * sampleRate) +
+        getLatencySamples(activeOversampling) + outputDelay;
+
+    silentSamples += buffer.getNumSamples();
+
+    if (sleeping || silentSamples > tailSamples) {
+      sleeping = true;
+
+      // Gates that are off are held open, so only the release since the
+      // gate last came on is owed on waking
+      sleptSamples = gateEnabled ? sleptSamples + buffer.getNumSamples() : 0;
+
+      for (int channel = 0; channel < numChannels; ++channel)
+        buffer.clear(channel, 0, buffer.getNumSamples());
+
+      return;
+    }
+  } else {
+    silentSamples = 0;
+
+    if (sleeping)
+      wakeUp();
+  }
+
+  auto kernel = selectKernel(params.clipMode, gateEnabled, params.mix < 1.0f);
+
+  // Hosts may exceed the block size announced in prepareToPlay
+  for (int start = 0; start < buffer.getNumSamples();
+       start += maximumBlockSize) {
+    auto numSamples = juce::jmin(maximumBlockSize, buffer.getNumSamples() - start);
+    (this->*kernel)(buffer, start, numSamples, numChannels, params);
+  }
+
+  // Keep the total latency where the host was told it is
+  const auto delay =
+      juce::jlimit(0, dryDelayLength - 1,
+                   params.latencySamples - getLatencySamples(activeOversampling));
+
+  if (delay != outputDelay) {
+    outputDelay = delay;
+    std::fill(outputDelayLine.begin(), outputDelayLine.end(), SampleType(0));
+    outputDelayPosition = 0;
+  }
+
+  if (delay > 0)
+    delayOutput(buffer, numChannels, delay);
+}
+
+template <typename SampleType>
+bool FuzzEngine<SampleType>::isSilent(
+    const juce::AudioBuffer<SampleType> &buffer, int numChannels,
+    const Parameters &params) {
+  // Upper bound on the gain from input to output: the clipper's steepest
+  // slope (1.5 for asymmetric, 1 / 0.7 for the Muff circuit) times drive and
+  // makeup, or 1 for the dry path.
+  // Band filters have at most unity gain, so multiband adds at most the sum
+  // of the band drives.
+  auto bandGain = 1.0f;
+
+  if (params.numBands > 1) {
+    bandGain = 0.0f;
+
+    for (int band = 0; band < juce::jmin(params.numBands, maxBands); ++band)
+      bandGain += params.bandGains[static_cast<size_t>(band)];
+  }
+
+  const auto maximumGain = juce::jmax(
+      1.0f, 1.5f * params.inputGain * params.makeupGain * bandGain);
+
+  for (int channel = 0; channel < numChannels; ++channel)
+    if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) * maximumGain >=
+        silenceFloor)
+      return false;
+
+  return true;
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::holdGatesOpen() {
+  const auto zero = Lanes::expand(0), one = Lanes::expand(1);
+
+  for (auto *gates : {&state.inputGate, &state.outputGate})
+    std::fill(gates->begin(), gates->end(), GateLanes{one, one, zero});
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::wakeUp() {
+  // Filter, oversampler, clipper history and dry delay state decayed below
+  // the silence floor before sleeping, so restarting them from rest is
+  // inaudible
+  std::fill(state.toneS1.begin(), state.toneS1.end(), Lanes::expand(0));
+  std::fill(state.toneS2.begin(), state.toneS2.end(), Lanes::expand(0));
+  std::fill(antialiasingState.begin(), antialiasingState.end(),
+            waveshaper::AntialiasingState());
+  std::fill(circuitState.begin(), circuitState.end(), SampleType(0));
+  resetBands();
+
+  for (auto &oversampler : oversamplers)
+    if (oversampler != nullptr)
+      oversampler->reset();
+
+  std::fill(dryDelayLine.begin(), dryDelayLine.end(), Lanes::expand(0));
+  dryDelayPosition = 0;
+  std::fill(outputDelayLine.begin(), outputDelayLine.end(), SampleType(0));
+  outputDelayPosition = 0;
+
+  // The gate envelopes were still releasing towards zero; apply the release
+  // they would have had over the slept samples. The signal was below every
+  // threshold, so both gates are closed with their hold expired.
+  auto advance = [this](std::vector<GateLanes> &gates,
+                        const GateCoefficients &coefficients) {
+    const auto decay = Lanes::expand(static_cast<SampleType>(
+        std::pow(static_cast<double>(coefficients.release),
+                 static_cast<double>(sleptSamples))));
+
+    for (auto &gate : gates) {
+      gate.gain = gate.gain * decay;
+      gate.open = gate.hold = Lanes::expand(0);
+    }
+  };
+
+  if (sleptSamples > 0) {
+    advance(state.inputGate, inputGateCoefficients);
+    advance(state.outputGate, outputGateCoefficients);
+  }
+
+  sleptSamples = 0;
+  sleeping = false;
+}
+
+template <typename SampleType>
+float FuzzEngine<SampleType>::getLowestGain(
+    const std::vector<GateLanes> &gates) const {
+  auto lowest = 1.0f;
+
+  for (int channel = 0; channel < activeChannels; ++channel) {
+    const auto &group =
+        gates[static_cast<size_t>(channel / lanesPerGroup)].gain;
+    const auto lane = static_cast<size_t>(channel % lanesPerGroup);
+    lowest = juce::jmin(lowest, static_cast<float>(group.get(lane)));
+  }
+
+  return lowest;
+}
+
+template <typename SampleType>
+int FuzzEngine<SampleType>::countClippedSamples(const SampleType *data,
+                                                int numSamples) {
+  int count = 0;
+
+  for (int sample = 0; sample < numSamples; ++sample)
+    count += std::abs(data[sample]) > SampleType(1) ? 1 : 0;
+
+  return count;
+}
+
+template <typename SampleType>
+typename FuzzEngine<SampleType>::Kernel
+FuzzEngine<SampleType>::selectKernel(int clipMode, bool gateEnabled,
+                                     bool blended) {
+  // [clipMode][gateEnabled][blended], instantiated at compile time
+  using Row = std::array<std::array<Kernel, 2>, 2>;
+
+  static constexpr Row kernels[numClipModes] = {
+      {{{&FuzzEngine::processKernel<hardClip, false, false>,
+         &FuzzEngine::processKernel<hardClip, false, true>},
+        {&FuzzEngine::processKernel<hardClip, true, false>,
+         &FuzzEngine::processKernel<hardClip, true, true>}}},
+      {{{&FuzzEngine::processKernel<softClip, false, false>,
+         &FuzzEngine::processKernel<softClip, false, true>},
+        {&FuzzEngine::processKernel<softClip, true, false>,
+         &FuzzEngine::processKernel<softClip, true, true>}}},
+      {{{&FuzzEngine::processKernel<asymmetricClip, false, false>,
+         &FuzzEngine::processKernel<asymmetricClip, false, true>},
+        {&FuzzEngine::processKernel<asymmetricClip, true, false>,
+         &FuzzEngine::processKernel<asymmetricClip, true, true>}}},
+      {{{&FuzzEngine::processKernel<muffClip, false, false>,
+         &FuzzEngine::processKernel<muffClip, false, true>},
+        {&FuzzEngine::processKernel<muffClip, true, false>,
+         &FuzzEngine::processKernel<muffClip, true, true>}}},
+  };
+
+  auto mode = juce::jlimit(0, numClipModes - 1, clipMode);
+  return kernels[mode][gateEnabled ? 1 : 0][blended ? 1 : 0];
+}
+
+template <typename SampleType>
+template <int clipMode, bool gateEnabled, bool blended>
+void FuzzEngine<SampleType>::processKernel(
+    juce::AudioBuffer<SampleType> &buffer, int startSample, int numSamples,
+    int numChannels, const Parameters &params) {
+  // Host rate and a stateless curve (or the bands, which ignore
+  // anti-aliasing): one fused pass, so the gate, tone filter and suppressor
+  // recurrences overlap instead of each taking its own trip through the block
+  if constexpr (clipMode != muffClip) {
+    if (activeOversampling == 0 &&
+        (activeBands > 1 ||
+         params.antialiasing == waveshaper::Antialiasing::off)) {
+      if (fillToneRamp(numSamples))
+        processFused<clipMode, gateEnabled, blended, true>(
+            buffer, startSample, numSamples, numChannels, params);
+      else
+        processFused<clipMode, gateEnabled, blended, false>(
+            buffer, startSample, numSamples, numChannels, params);
+      return;
+    }
+  }
+
+  const auto numActiveGroups = getNumGroups(numChannels, lanesPerGroup);
+  auto *wet = wetLanes.data();
+
+  auto dryGroup = [this](int group) {
+    return dryLanes.data() + group * maximumBlockSize;
+  };
+
+  // --- Stage 1: Input Gate (Tight) ---
+  // Without gate and dry path the host buffer already holds the clipper input
+  if constexpr (gateEnabled || blended) {
+    for (int group = 0; group < numActiveGroups; ++group) {
+      auto *dry = dryGroup(group);
+      gather(buffer, startSample, numSamples, group, numChannels, dry);
+
+      if constexpr (gateEnabled) {
+        processGate(dry, numSamples,
+                    state.inputGate[static_cast<size_t>(group)],
+                    params.gateThreshold, params, inputGateCoefficients);
+        scatter(dry, numSamples, group, numChannels, buffer, startSample);
+      }
+    }
+  }
+
+  // --- Stage 2: Gain and clipping (per channel, vectorised over time) ---
+  processClipStage<clipMode>(buffer, startSample, numSamples, numChannels,
+                             params);
+
+  // Keep the dry path aligned with the oversampled wet path
+  if constexpr (blended)
+    delayDry(numActiveGroups, numSamples, getLatencySamples(activeOversampling));
+
+  // Per-sample coefficients while the cutoff glides, shared by every group
+  const auto toneRamping = fillToneRamp(numSamples);
+
+  for (int group = 0; group < numActiveGroups; ++group) {
+    const auto index = static_cast<size_t>(group);
+
+    // --- Stage 3: Tone filter (low-pass) ---
+    gather(buffer, startSample, numSamples, group, numChannels, wet);
+
+    if (toneRamping)
+      processToneFilter<true>(wet, numSamples, state.toneS1[index],
+                              state.toneS2[index]);
+    else
+      processToneFilter<false>(wet, numSamples, state.toneS1[index],
+                               state.toneS2[index]);
+
+    // --- Stage 4: Makeup gain and dry/wet mix ---
+    processMakeupAndMix<blended>(
+        reinterpret_cast<SampleType *>(wet),
+        reinterpret_cast<const SampleType *>(dryGroup(group)),
+        numSamples * lanesPerGroup, static_cast<SampleType>(params.makeupGain),
+        static_cast<SampleType>(params.mix));
+
+    // --- Stage 5: Output Suppressor (Smooth) ---
+    // Half threshold for output to keep tails
+    if constexpr (gateEnabled)
+      processGate(wet, numSamples, state.outputGate[index],
+                  params.gateThreshold * 0.5f, params, outputGateCoefficients);
+
+    scatter(wet, numSamples, group, numChannels, buffer, startSample);
+  }
+}
+
+template <typename SampleType>
+template <int clipMode, bool gateEnabled, bool blended, bool ramping>
+void FuzzEngine<SampleType>::processFused(
+    juce::AudioBuffer<SampleType> &buffer, int startSample, int numSamples,
+    int numChannels, const Parameters &params) {
+  const auto numActiveGroups = getNumGroups(numChannels, lanesPerGroup);
+  const auto inputGateConstants = makeGateConstants(
+      params.gateThreshold, params, inputGateCoefficients);
+  const auto hysteresis = params.gateHysteresis < 1.0f;
+  const auto outputGateConstants = makeGateConstants(
+      params.gateThreshold * 0.5f, params, outputGateCoefficients);
+
+  const auto one = Lanes::expand(1);
+  const auto inputGain = Lanes::expand(static_cast<SampleType>(params.inputGain));
+  const auto makeupGain =
+      Lanes::expand(static_cast<SampleType>(params.makeupGain));
+  const auto mix = static_cast<SampleType>(params.mix);
+  const auto wetMix = Lanes::expand(mix);
+  const auto dryMix = Lanes::expand(SampleType(1) - mix);
+
+  const auto r2 = Lanes::expand(toneR2);
+  auto g = Lanes::expand(toneG);
+  auto h = Lanes::expand(toneH);
+  auto gPlusR2 = Lanes::expand(toneG + toneR2);
+
+  for (int group = 0; group < numActiveGroups; ++group) {
+    const auto index = static_cast<size_t>(group);
+    auto *lanes = wetLanes.data();
+    auto *dryValues = dryLanes.data();
+    gather(buffer, startSample, numSamples, group, numChannels, lanes);
+
+    auto outputGate = state.outputGate[index];
+    auto s1 = state.toneS1[index];
+    auto s2 = state.toneS2[index];
+    auto clipped = Lanes::expand(0);
+
+    // --- Stage 1: Input Gate (Tight), then the drive ---
+    // The input gate only depends on the input, so all its segments are
+    // decided up front, off the tone filter's critical path
+    const GateSegment *inputRamps = nullptr;
+
+    if constexpr (gateEnabled)
+      inputRamps = decideGate(lanes, numSamples, state.inputGate[index],
+                              inputGateConstants, hysteresis);
+
+    auto front = [&](Lanes x, Lanes &dry, int segment, int position) {
+      if constexpr (gateEnabled)
+        x = applyGate(x, inputRamps[segment],
+                      gateRamp[static_cast<size_t>(position)]);
+      else
+        juce::ignoreUnused(segment, position);
+
+      dry = x;
+      auto wet = x * inputGain;
+
+      // Counted before the curve, as on the other paths
+      clipped += one & Lanes::greaterThan(absLanes(wet), one);
+      return wet;
+    };
+
+    // --- Stages 3-4: Tone filter, makeup gain and mix ---
+    auto back = [&](Lanes wet, Lanes dry, int sample) {
+      if constexpr (ramping) {
+        g = Lanes::expand(toneRampG[static_cast<size_t>(sample)]);
+        h = Lanes::expand(toneRampH[static_cast<size_t>(sample)]);
+        gPlusR2 = g + r2;
+      }
+
+      wet = processToneSample(wet, s1, s2, g, h, gPlusR2) * makeupGain;
+
+      if constexpr (blended)
+        return wet * wetMix + dry * dryMix;
+
+      juce::ignoreUnused(dry);
+      return wet;
+    };
+
+    // --- Stage 5: Output Suppressor (Smooth) ---
+    // Decided once per gate segment from the samples the loop counted above
+    // the threshold; without the gate the block is one segment
+    const auto interval = gateEnabled ? gateInterval : numSamples;
+
+    auto countOutput = [&](Lanes wet, GateCounts &counts) {
+      if constexpr (gateEnabled)
+        countGateSample<true>(wet, outputGateConstants, counts);
+      else
+        juce::ignoreUnused(wet, counts);
+    };
+
+    auto processOutputGate = [&](int start, int length,
+                                 const GateCounts &counts) {
+      if constexpr (gateEnabled) {
+        const auto ramp =
+            startGateSegment(outputGate, counts, length, outputGateConstants);
+
+        for (int sample = 0; sample < length; ++sample)
+          lanes[start + sample] = applyGate(
+              lanes[start + sample], ramp,
+              gateRamp[static_cast<size_t>(sample)]);
+      } else {
+        juce::ignoreUnused(start, length, counts);
+      }
+    };
+
+    // --- Stage 2: Clipping ---
+    if (clipMode == hardClip && activeBands == 1) {
+      for (int start = 0, segment = 0; start < numSamples;
+           start += interval, ++segment) {
+        const auto length = juce::jmin(interval, numSamples - start);
+        GateCounts counts{};
+
+        for (int sample = start; sample < start + length; ++sample) {
+          Lanes dry;
+          auto wet = waveshaper::detail::clamp(
+              front(lanes[sample], dry, segment, sample - start), 1.0f);
+          lanes[sample] = back(wet, dry, sample);
+          countOutput(lanes[sample], counts);
+        }
+
+        processOutputGate(start, length, counts);
+      }
+    } else {
+      // The tanh curves divide, which SIMDRegister cannot, and the bands need
+      // the lanes for themselves; both run per used channel between the two
+      // recursive halves. Anti-aliasing is off (or ignored by the bands), so
+      // the history is left alone.
+      for (int start = 0, segment = 0; start < numSamples;
+           start += interval, ++segment)
+        for (int sample = start;
+             sample < juce::jmin(numSamples, start + interval); ++sample)
+          lanes[sample] =
+              front(lanes[sample], dryValues[sample], segment, sample - start);
+
+      scatter(lanes, numSamples, group, numChannels, buffer, startSample);
+
+      for (int channel = group * lanesPerGroup;
+           channel < juce::jmin(numChannels, (group + 1) * lanesPerGroup);
+           ++channel) {
+        auto *data = buffer.getWritePointer(channel, startSample);
+
+        if (activeBands > 1)
+          processMultiband(data, numSamples, static_cast<size_t>(channel),
+                           params.precision);
+        else
+          processClipper<clipMode>(data, numSamples, params,
+                                   antialiasingState.front());
+      }
+
+      gather(buffer, startSample, numSamples, group, numChannels, lanes);
+
+      for (int start = 0; start < numSamples; start += interval) {
+        const auto length = juce::jmin(interval, numSamples - start);
+        GateCounts counts{};
+
+        for (int sample = start; sample < start + length; ++sample) {
+          lanes[sample] = back(lanes[sample], dryValues[sample], sample);
+          countOutput(lanes[sample], counts);
+        }
+
+        processOutputGate(start, length, counts);
+      }
+    }
+
+    state.outputGate[index] = outputGate;
+    state.toneS1[index] = s1;
+    state.toneS2[index] = s2;
+    clippedSamples += static_cast<int>(clipped.sum());
+
+    scatter(lanes, numSamples, group, numChannels, buffer, startSample);
+  }
+}
+
+template <typename SampleType>
+template <int clipMode>
+void FuzzEngine<SampleType>::processClipStage(
+    juce::AudioBuffer<SampleType> &buffer, int startSample, int numSamples,
+    int numChannels, const Parameters &params) {
+  for (int channel = 0; channel < numChannels; ++channel)
+    juce::FloatVectorOperations::multiply(
+        buffer.getWritePointer(channel, startSample),
+        static_cast<SampleType>(params.inputGain), numSamples);
+
+  // Counted at the host rate, before any oversampling
+  for (int channel = 0; channel < numChannels; ++channel)
+    clippedSamples += countClippedSamples(
+        buffer.getReadPointer(channel, startSample), numSamples);
+
+  // The single clipper, or the bands of the multiband one
+  auto clip = [this, &params](SampleType *data, int numValues, size_t channel) {
+    if (activeBands > 1)
+      processMultiband(data, numValues, channel, params.precision);
+    else if constexpr (clipMode == muffClip)
+      processCircuit(data, numValues, params, circuitState[channel]);
+    else
+      processClipper<clipMode>(data, numValues, params,
+                               antialiasingState[channel]);
+  };
+
+  if (activeOversampling == 0) {
+    for (int channel = 0; channel < numChannels; ++channel)
+      clip(buffer.getWritePointer(channel, startSample), numSamples,
+           static_cast<size_t>(channel));
+    return;
+  }
+
+  // Only the nonlinearity runs at the higher rate
+  auto &oversampler = *oversamplers[static_cast<size_t>(activeOversampling - 1)];
+
+  juce::dsp::AudioBlock<SampleType> block(buffer.getArrayOfWritePointers(),
+                                     static_cast<size_t>(numChannels),
+                                     static_cast<size_t>(startSample),
+                                     static_cast<size_t>(numSamples));
+
+  auto oversampledBlock = oversampler.processSamplesUp(block);
+
+  for (size_t channel = 0; channel < oversampledBlock.getNumChannels();
+       ++channel)
+    clip(oversampledBlock.getChannelPointer(channel),
+         static_cast<int>(oversampledBlock.getNumSamples()), channel);
+
+  oversampler.processSamplesDown(block);
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::delayDry(int numActiveGroups, int numSamples,
+                                      int delaySamples) {
+  if (delaySamples <= 0)
+    return;
+
+  // Circular buffers of delaySamples + 1 slots inside the preallocated lines,
+  // one per group, sharing the write position
+  auto length = delaySamples + 1;
+  jassert(length <= dryDelayLength);
+
+  for (int sample = 0; sample < numSamples; ++sample) {
+    auto readPosition = dryDelayPosition + 1;
+    if (readPosition == length)
+      readPosition = 0;
+
+    for (int group = 0; group < numActiveGroups; ++group) {
+      auto *line = dryDelayLine.data() + group * dryDelayLength;
+      auto &value =
+          dryLanes[static_cast<size_t>(group * maximumBlockSize + sample)];
+
+      line[dryDelayPosition] = value;
+      value = line[readPosition];
+    }
+
+    dryDelayPosition = readPosition;
+  }
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::delayOutput(juce::AudioBuffer<SampleType> &buffer,
+                                         int numChannels, int delaySamples) {
+  // Same circular scheme as the dry delay, one line per channel
+  const auto length = delaySamples + 1;
+  auto position = outputDelayPosition;
+
+  for (int channel = 0; channel < numChannels; ++channel) {
+    auto *line = outputDelayLine.data() + channel * dryDelayLength;
+    auto *data = buffer.getWritePointer(channel);
+    position = outputDelayPosition;
+
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
+      auto readPosition = position + 1;
+      if (readPosition == length)
+        readPosition = 0;
+
+      line[position] = data[sample];
+      data[sample] = line[readPosition];
+      position = readPosition;
+    }
+  }
+
+  outputDelayPosition = position;
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::updateToneCoefficients(float frequency) {
+  // Same coefficient derivation as juce::dsp::StateVariableTPTFilter with the
+  // default (Butterworth) resonance, so the lanes filter is a drop-in match.
+  const auto resonance = static_cast<SampleType>(1.0 / std::sqrt(2.0));
+
+  toneFrequency = frequency;
+  toneG = static_cast<SampleType>(
+      std::tan(juce::MathConstants<double>::pi * frequency / sampleRate));
+  toneR2 = static_cast<SampleType>(1.0 / resonance);
+  toneH = static_cast<SampleType>(1.0 / (1.0 + toneR2 * toneG + toneG * toneG));
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::setToneTarget(float frequency) {
+  toneTarget = frequency;
+  toneTargetPosition = toneTable->getPosition(frequency);
+
+  // Nothing to glide from on the first block, or while asleep (the filter
+  // restarts from rest when the engine wakes)
+  if (toneFrequency < 0.0f || sleeping) {
+    updateToneCoefficients(frequency);
+    tonePosition = toneTargetPosition;
+    toneRampSamples = 0;
+    return;
+  }
+
+  // A new target mid-glide continues from the current position
+  toneRampSamples = toneRampLength;
+  toneStep = (toneTargetPosition - tonePosition) /
+             static_cast<float>(toneRampLength);
+}
+
+template <typename SampleType>
+bool FuzzEngine<SampleType>::fillToneRamp(int numSamples) {
+  if (toneRampSamples == 0)
+    return false;
+
+  for (int sample = 0; sample < numSamples; ++sample) {
+    typename SvfCoefficientTable<SampleType>::Coefficients coefficients{toneG,
+                                                                        toneH};
+
+    if (toneRampSamples > 0) {
+      if (--toneRampSamples == 0) {
+        // Settled: exact coefficients for the rest of the block and after
+        tonePosition = toneTargetPosition;
+        updateToneCoefficients(toneTarget);
+        coefficients = {toneG, toneH};
+      } else {
+        tonePosition += toneStep;
+        coefficients = toneTable->getCoefficients(tonePosition);
+      }
+    }
+
+    toneRampG[static_cast<size_t>(sample)] = coefficients.g;
+    toneRampH[static_cast<size_t>(sample)] = coefficients.h;
+  }
+
+  return true;
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::gather(const juce::AudioBuffer<SampleType> &buffer,
+                                    int startSample, int numSamples, int group,
+                                    int numChannels, Lanes *dest) {
+  auto *interleaved = reinterpret_cast<SampleType *>(dest);
+  const auto firstChannel = group * lanesPerGroup;
+
+  for (int lane = 0; lane < lanesPerGroup; ++lane) {
+    auto channel = firstChannel + lane;
+
+    if (channel < numChannels) {
+      auto *source = buffer.getReadPointer(channel, startSample);
+
+      for (int sample = 0; sample < numSamples; ++sample)
+        interleaved[sample * lanesPerGroup + lane] = source[sample];
+    } else {
+      // Unused lanes carry silence so their state stays well defined
+      for (int sample = 0; sample < numSamples; ++sample)
+        interleaved[sample * lanesPerGroup + lane] = 0;
+    }
+  }
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::scatter(const Lanes *source, int numSamples,
+                                     int group, int numChannels,
+                                     juce::AudioBuffer<SampleType> &buffer,
+                                     int startSample) {
+  auto *interleaved = reinterpret_cast<const SampleType *>(source);
+  const auto firstChannel = group * lanesPerGroup;
+  const auto numLanes = juce::jmin(lanesPerGroup, numChannels - firstChannel);
+
+  for (int lane = 0; lane < numLanes; ++lane) {
+    auto *dest = buffer.getWritePointer(firstChannel + lane, startSample);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+      dest[sample] = interleaved[sample * lanesPerGroup + lane];
+  }
+}
+
+template <typename SampleType>
+typename FuzzEngine<SampleType>::GateConstants
+FuzzEngine<SampleType>::makeGateConstants(
+    SampleType threshold, const Parameters &params,
+    const GateCoefficients &coefficients) const {
+  return {Lanes::expand(threshold),
+          Lanes::expand(threshold *
+                        static_cast<SampleType>(params.gateHysteresis)),
+          Lanes::expand(static_cast<SampleType>(params.gateHold * sampleRate)),
+          Lanes::expand(coefficients.logAttack),
+          Lanes::expand(coefficients.logRelease)};
+}
+
+template <typename SampleType>
+template <bool hysteresis>
+JUCE_FORCEINLINE void
+FuzzEngine<SampleType>::countGateSample(Lanes input,
+                                        const GateConstants &constants,
+                                        GateCounts &counts) {
+  const auto one = Lanes::expand(1);
+  const auto level = absLanes(input);
+
+  counts.aboveOpen +=
+      one & Lanes::greaterThan(level, constants.openThreshold);
+
+  if constexpr (hysteresis)
+    counts.aboveClose +=
+        one & Lanes::greaterThan(level, constants.closeThreshold);
+  else
+    counts.aboveClose = counts.aboveOpen;
+}
+
+template <typename SampleType>
+JUCE_FORCEINLINE typename FuzzEngine<SampleType>::GateSegment
+FuzzEngine<SampleType>::startGateSegment(GateLanes &gate,
+                                         const GateCounts &counts,
+                                         int numSamples,
+                                         const GateConstants &constants) {
+  const auto zero = Lanes::expand(0);
+  const auto one = Lanes::expand(1);
+  const auto length = Lanes::expand(static_cast<SampleType>(numSamples));
+
+  // An open gate stays open down to the lower closing threshold
+  auto wasOpen = Lanes::greaterThan(gate.open, zero);
+  auto above = (counts.aboveClose & wasOpen) + (counts.aboveOpen & ~wasOpen);
+
+  // Samples the gate wants open: those above the threshold, or at least the
+  // ones the hold still covers. Any sample above it restarts the hold.
+  auto open = Lanes::max(above, Lanes::min(gate.hold, length));
+  auto triggered = Lanes::greaterThan(above, zero);
+  gate.hold = (constants.holdSamples & triggered) +
+              (Lanes::max(gate.hold - length, zero) & ~triggered);
+  gate.open = one & (triggered | Lanes::greaterThan(gate.hold, zero));
+
+  // The per-sample envelope attacks on open samples and releases on the
+  // others; over a segment that is attack^open * release^closed, whatever
+  // their order to first order in the (small) per-sample steps. A segment is
+  // at most a twentieth of the fastest time constant, so the exponent stays
+  // within [-0.05, 0] and a cubic is exact to 3e-7.
+  auto power = [one](Lanes x) {
+    const auto half = Lanes::expand(SampleType(0.5));
+    const auto third = Lanes::expand(SampleType(1) / SampleType(3));
+    return one + x * (one + x * half * (one + x * third));
+  };
+
+  auto attack = power(open * constants.logAttack);
+  auto release = power((length - open) * constants.logRelease);
+  auto target = (one - (one - gate.gain) * attack) * release;
+
+  // Reached with a linear ramp across the segment
+  GateSegment segment{
+      gate.gain,
+      (target - gate.gain) *
+          Lanes::expand(SampleType(1) / static_cast<SampleType>(numSamples))};
+  gate.gain = target;
+  return segment;
+}
+
+template <typename SampleType>
+JUCE_FORCEINLINE typename FuzzEngine<SampleType>::Lanes
+FuzzEngine<SampleType>::applyGate(Lanes input, const GateSegment &segment,
+                                  Lanes position) {
+  return input * (segment.start + segment.step * position);
+}
+
+template <typename SampleType>
+const typename FuzzEngine<SampleType>::GateSegment *
+FuzzEngine<SampleType>::decideGate(const Lanes *data, int numSamples,
+                                   GateLanes &gate,
+                                   const GateConstants &constants,
+                                   bool hysteresis) {
+  const auto numSegments = (numSamples + gateInterval - 1) / gateInterval;
+  jassert(numSegments <= static_cast<int>(gateSegments.size()));
+
+  // Count every segment first: the counts do not depend on the gate state,
+  // so the segments overlap instead of each waiting for the last decision
+  auto count = [&](auto withHysteresis) {
+    for (int segment = 0; segment < numSegments; ++segment) {
+      const auto start = segment * gateInterval;
+      const auto end = juce::jmin(numSamples, start + gateInterval);
+      GateCounts counts{};
+
+      for (int sample = start; sample < end; ++sample)
+        countGateSample<decltype(withHysteresis)::value>(data[sample],
+                                                         constants, counts);
+
+      gateCounts[static_cast<size_t>(segment)] = counts;
+    }
+  };
+
+  if (hysteresis)
+    count(std::true_type());
+  else
+    count(std::false_type());
+
+  auto current = gate;
+
+  for (int segment = 0; segment < numSegments; ++segment) {
+    const auto index = static_cast<size_t>(segment);
+    gateSegments[index] = startGateSegment(
+        current, gateCounts[index],
+        juce::jmin(gateInterval, numSamples - segment * gateInterval),
+        constants);
+  }
+
+  gate = current;
+  return gateSegments.data();
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::processGate(
+    Lanes *data, int numSamples, GateLanes &gate, SampleType threshold,
+    const Parameters &params, const GateCoefficients &coefficients) {
+  const auto *segments =
+      decideGate(data, numSamples, gate,
+                 makeGateConstants(threshold, params, coefficients),
+                 params.gateHysteresis < 1.0f);
+
+  for (int start = 0; start < numSamples; start += gateInterval) {
+    const auto &ramp = *segments++;
+    const auto length = juce::jmin(gateInterval, numSamples - start);
+
+    for (int sample = 0; sample < length; ++sample)
+      data[start + sample] = applyGate(data[start + sample], ramp,
+                                       gateRamp[static_cast<size_t>(sample)]);
+  }
+}
+
+template <typename SampleType>
+JUCE_FORCEINLINE typename FuzzEngine<SampleType>::Lanes
+FuzzEngine<SampleType>::processToneSample(Lanes input, Lanes &s1, Lanes &s2,
+                                          Lanes g, Lanes h, Lanes gPlusR2) {
+  auto yHP = h * (input - s1 * gPlusR2 - s2);
+
+  auto yBP = yHP * g + s1;
+  s1 = yHP * g + yBP;
+
+  auto yLP = yBP * g + s2;
+  s2 = yBP * g + yLP;
+
+  return yLP;
+}
+
+template <typename SampleType>
+template <bool ramping>
+void FuzzEngine<SampleType>::processToneFilter(Lanes *data, int numSamples,
+                                               Lanes &toneS1, Lanes &toneS2) {
+  const auto r2 = Lanes::expand(toneR2);
+  auto g = Lanes::expand(toneG);
+  auto h = Lanes::expand(toneH);
+  auto gPlusR2 = Lanes::expand(toneG + toneR2);
+
+  auto s1 = toneS1;
+  auto s2 = toneS2;
+
+  for (int sample = 0; sample < numSamples; ++sample) {
+    if constexpr (ramping) {
+      g = Lanes::expand(toneRampG[static_cast<size_t>(sample)]);
+      h = Lanes::expand(toneRampH[static_cast<size_t>(sample)]);
+      gPlusR2 = g + r2;
+    }
+
+    data[sample] = processToneSample(data[sample], s1, s2, g, h, gPlusR2);
+  }
+
+  toneS1 = s1;
+  toneS2 = s2;
+}
+
+template <typename SampleType>
+template <int clipMode>
+void FuzzEngine<SampleType>::processClipper(
+    SampleType *data, int numSamples, const Parameters &params,
+    waveshaper::AntialiasingState &history) {
+  using namespace waveshaper;
+  using Curve = std::conditional_t<
+      clipMode == hardClip, HardClip,
+      std::conditional_t<clipMode == softClip, SoftClip, AsymmetricClip>>;
+
+  // The anti-aliased curves have a single (double) precision
+  switch (params.antialiasing) {
+  case Antialiasing::firstOrder:
+    processFirstOrder<Curve>(data, numSamples, history);
+    return;
+  case Antialiasing::secondOrder:
+    processSecondOrder<Curve>(data, numSamples, history);
+    return;
+  case Antialiasing::off:
+  case Antialiasing::numModes:
+    break;
+  }
+
+  if constexpr (clipMode == hardClip) {
+    // Exact at every precision
+    juce::FloatVectorOperations::clip(data, data, SampleType(-1), SampleType(1),
+                                      numSamples);
+  } else {
+    switch (params.precision) {
+    case Precision::eco:
+      waveshaper::processBlock<Curve, Precision::eco>(data, numSamples);
+      break;
+    case Precision::standard:
+      waveshaper::processBlock<Curve, Precision::standard>(data, numSamples);
+      break;
+    case Precision::high:
+    case Precision::numPrecisions:
+      waveshaper::processBlock<Curve, Precision::high>(data, numSamples);
+      break;
+    }
+  }
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::processCircuit(SampleType *data, int numSamples,
+                                            const Parameters &params,
+                                            SampleType &capacitorState) const {
+  using waveshaper::Precision;
+  const auto &circuit = *circuits[static_cast<size_t>(activeOversampling)];
+
+  switch (params.precision) {
+  case Precision::eco:
+    circuit.template process<Precision::eco>(data, numSamples, capacitorState);
+    break;
+  case Precision::standard:
+    circuit.template process<Precision::standard>(data, numSamples,
+                                                  capacitorState);
+    break;
+  case Precision::high:
+  case Precision::numPrecisions:
+    circuit.template process<Precision::high>(data, numSamples,
+                                              capacitorState);
+    break;
+  }
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::updateBands(const Parameters &params) {
+  const auto numBands = juce::jlimit(1, maxBands, params.numBands);
+
+  // Entering, leaving or resizing multiband starts the crossovers from rest
+  if (numBands != activeBands) {
+    activeBands = numBands;
+    bandRate = 0.0;
+    resetBands();
+  }
+
+  if (numBands == 1)
+    return;
+
+  const auto rate = sampleRate * static_cast<double>(1 << activeOversampling);
+
+  // Lane mixes of the two sections of one crossover: {direct, low-pass,
+  // band-pass, high-pass}
+  using Mix = std::array<double, 4>;
+  const auto r2 = std::sqrt(2.0); // Butterworth
+
+  if (rate != bandRate || params.crossoverFrequencies != bandFrequencies) {
+    bandRate = rate;
+    bandFrequencies = params.crossoverFrequencies;
+
+    for (size_t crossover = 0; crossover < bandFrequencies.size();
+         ++crossover) {
+      const auto frequency = juce::jmin(
+          0.45 * rate,
+          static_cast<double>(juce::jlimit(crossoverLimits[crossover],
+                                           crossoverLimits[crossover + 1],
+                                           bandFrequencies[crossover])));
+      const auto g = std::tan(juce::MathConstants<double>::pi * frequency /
+                              rate);
+      const auto h = 1.0 / (1.0 + r2 * g + g * g);
+
+      auto &first = bandSections[2 * crossover];
+      auto &second = bandSections[2 * crossover + 1];
+
+      // With HP = h v, BP = g HP + s1 and LP = g BP + s2, the states move
+      // by 2g HP and 2g BP
+      auto lanes = [](double value) {
+        return Lanes::expand(static_cast<SampleType>(value));
+      };
+
+      for (auto *section : {&first, &second}) {
+        section->gPlusR2 = lanes(g + r2);
+        section->s1v = lanes(2.0 * g * h);
+        section->s2v = lanes(2.0 * g * g * h);
+        section->s2s1 = lanes(2.0 * g);
+      }
+
+      // LR4 = two Butterworth sections. The band just below the crossover
+      // takes its low-pass, the bands above it its high-pass, and the bands
+      // further below its all-pass (one section's worth), which keeps every
+      // band in phase with the others.
+      for (int band = 0; band < maxBands; ++band) {
+        Mix firstMix{}, secondMix{};
+
+        if (band < numBands) {
+          const auto index = static_cast<int>(crossover);
+
+          if (band == index)
+            firstMix = secondMix = Mix{0, 1, 0, 0};
+          else if (band > index)
+            firstMix = secondMix = Mix{0, 0, 0, 1};
+          else {
+            firstMix = Mix{0, 1, -r2, 1};
+            secondMix = Mix{1, 0, 0, 0};
+          }
+        }
+
+        const auto group = static_cast<size_t>(band / lanesPerGroup);
+        const auto lane = static_cast<size_t>(band % lanesPerGroup);
+
+        // direct x + low LP + band BP + high HP, as a function of v, s1, s2
+        for (auto [section, mix] : {std::make_pair(&first, firstMix),
+                                    std::make_pair(&second, secondMix)}) {
+          const auto [direct, low, band, high] = mix;
+          const auto highPass = low * g * g + band * g + high;
+
+          section->ov[group].set(
+              lane, static_cast<SampleType>(direct + highPass * h));
+          section->oa[group].set(
+              lane, static_cast<SampleType>(direct * (g + r2) + low * g + band));
+          section->ob[group].set(lane, static_cast<SampleType>(direct + low));
+        }
+      }
+    }
+  }
+
+  // Drive and curve per lane; unused bands have no drive and stay silent
+  using Mask = typename Lanes::MaskType;
+  bandCurves = {false, false};
+
+  for (int band = 0; band < maxBands; ++band) {
+    const auto group = static_cast<size_t>(band / lanesPerGroup);
+    const auto lane = static_cast<size_t>(band % lanesPerGroup);
+    const auto mode = juce::jlimit(
+        0, static_cast<int>(asymmetricClip),
+        params.bandClipModes[static_cast<size_t>(band)]);
+    const auto gain = band < numBands
+                          ? params.bandGains[static_cast<size_t>(band)]
+                          : 0.0f;
+
+    if (band < numBands) {
+      bandCurves.hard = bandCurves.hard || mode != softClip;
+      bandCurves.shaped = bandCurves.shaped || mode != hardClip;
+    }
+
+    bandDrive[group].set(lane, static_cast<SampleType>(gain));
+    bandTanhDrive[group].set(
+        lane, static_cast<SampleType>(mode == asymmetricClip ? 1.5f : 1.0f));
+    bandSoftMask[group].set(lane, mode == softClip ? ~Mask(0) : Mask(0));
+    bandAsymmetricMask[group].set(lane,
+                                  mode == asymmetricClip ? ~Mask(0) : Mask(0));
+  }
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::resetBands() {
+  for (auto *states : {&bandS1, &bandS2})
+    for (auto &bandState : *states)
+      bandState.fill(Lanes::expand(0));
+}
+
+template <typename SampleType>
+void FuzzEngine<SampleType>::processMultiband(SampleType *data, int numSamples,
+                                              size_t channel,
+                                              waveshaper::Precision precision) {
+  using waveshaper::Precision;
+
+  auto &s1 = bandS1[channel];
+  auto &s2 = bandS2[channel];
+
+  switch (precision) {
+  case Precision::eco:
+    processBands<Precision::eco>(data, numSamples, s1, s2);
+    break;
+  case Precision::standard:
+    processBands<Precision::standard>(data, numSamples, s1, s2);
+    break;
+  case Precision::high:
+  case Precision::numPrecisions:
+    processBands<Precision::high>(data, numSamples, s1, s2);
+    break;
+  }
+}
+
+template <typename SampleType>
+template <waveshaper::Precision precision>
+void FuzzEngine<SampleType>::processBands(SampleType *data, int numSamples,
+                                          BandState &s1, BandState &s2) const {
+  constexpr auto numValues = numBandRegisters * lanesPerGroup;
+
+  const auto numRegisters = (activeBands + lanesPerGroup - 1) / lanesPerGroup;
+
+  // One chunk's bands after the crossovers, and their values after the curves
+  std::array<Lanes, bandChunkSize * numBandRegisters> bands;
+  alignas(Lanes) std::array<SampleType, bandChunkSize * numValues> values;
+
+  for (int start = 0; start < numSamples; start += bandChunkSize) {
+    const auto length = juce::jmin(bandChunkSize, numSamples - start);
+    auto *chunk = data + start;
+
+    switch (activeBands) {
+    case 2:
+      splitBands<2>(chunk, bands.data(), length, numRegisters, s1, s2);
+      break;
+    case 3:
+      splitBands<4>(chunk, bands.data(), length, numRegisters, s1, s2);
+      break;
+    default:
+      splitBands<6>(chunk, bands.data(), length, numRegisters, s1, s2);
+      break;
+    }
+
+    if (!bandCurves.shaped)
+      clipBands<precision, true, false>(bands.data(), values.data(), length,
+                                        numRegisters);
+    else if (!bandCurves.hard)
+      clipBands<precision, false, true>(bands.data(), values.data(), length,
+                                        numRegisters);
+    else
+      clipBands<precision, true, true>(bands.data(), values.data(), length,
+                                       numRegisters);
+
+    // Sum of the bands: a fixed stride the compiler vectorises with
+    // shuffles, not a horizontal add per sample
+    for (int sample = 0; sample < length; ++sample) {
+      const auto *bandValues = values.data() + sample * numValues;
+      SampleType sum = 0;
+
+      for (int value = 0; value < numValues; ++value)
+        sum += bandValues[value];
+
+      chunk[sample] = sum;
+    }
+  }
+
+}
+
+template <typename SampleType>
+template <int numSections>
+void FuzzEngine<SampleType>::splitBands(const SampleType *input, Lanes *bands,
+                                        int numSamples, int numRegisters,
+                                        BandState &s1, BandState &s2) const {
+  for (int group = 0; group < numRegisters; ++group) {
+    const auto index = static_cast<size_t>(group);
+
+    // The states stay in registers across the chunk
+    std::array<Lanes, numSections> z1, z2;
+
+    for (size_t section = 0; section < numSections; ++section) {
+      z1[section] = s1[section * numBandRegisters + index];
+      z2[section] = s2[section * numBandRegisters + index];
+    }
+
+    // Every band at once. The output of a section waits on its input for a
+    // subtract and a multiply-add; the state terms are ready early.
+    for (int sample = 0; sample < numSamples; ++sample) {
+      auto x = Lanes::expand(input[sample]);
+
+      for (size_t section = 0; section < numSections; ++section) {
+        const auto &c = bandSections[section];
+        auto &a = z1[section];
+        auto &b = z2[section];
+
+        const auto v = x - (a * c.gPlusR2 + b);
+        const auto output = v * c.ov[index] + (a * c.oa[index] + b * c.ob[index]);
+
+        b += v * c.s2v + a * c.s2s1;
+        a += v * c.s1v;
+        x = output;
+      }
+
+      bands[static_cast<size_t>(sample * numBandRegisters + group)] = x;
+    }
+
+    for (size_t section = 0; section < numSections; ++section) {
+      s1[section * numBandRegisters + index] = z1[section];
+      s2[section * numBandRegisters + index] = z2[section];
+    }
+  }
+}
+
+template <typename SampleType>
+template <waveshaper::Precision precision, bool hard, bool shaped>
+void FuzzEngine<SampleType>::clipBands(const Lanes *bands, SampleType *values,
+                                       int numSamples,
+                                       int numRegisters) const {
+  using waveshaper::Tanh;
+
+  const auto zero = Lanes::expand(0);
+
+  for (int sample = 0; sample < numSamples; ++sample)
+    for (int group = 0; group < numBandRegisters; ++group) {
+      const auto index = static_cast<size_t>(group);
+      auto *output = values + (sample * numBandRegisters + group) * lanesPerGroup;
+
+      // Registers above the last band are silent
+      if (group >= numRegisters) {
+        zero.copyToRawArray(output);
+        continue;
+      }
+
+      const auto x = bands[sample * numBandRegisters + group] * bandDrive[index];
+
+      // Soft lanes take tanh, asymmetric lanes tanh(1.5x) on the positive
+      // half, everything else the hard clip
+      if constexpr (hard && shaped) {
+        const auto clipped = waveshaper::detail::clamp(x, 1.0f);
+        const auto shapedValue =
+            Tanh::template process<precision>(x * bandTanhDrive[index]);
+        const auto useShaped =
+            bandSoftMask[index] |
+            (bandAsymmetricMask[index] & Lanes::greaterThan(x, zero));
+
+        ((shapedValue & useShaped) + (clipped & ~useShaped))
+            .copyToRawArray(output);
+      } else if constexpr (shaped) {
+        Tanh::template process<precision>(x * bandTanhDrive[index])
+            .copyToRawArray(output);
+      } else {
+        waveshaper::detail::clamp(x, 1.0f).copyToRawArray(output);
+      }
+    }
+}
+
+template <typename SampleType>
+template <bool blended>
+void FuzzEngine<SampleType>::processMakeupAndMix(SampleType *wet,
+                                                 const SampleType *dry,
+                                                 int numValues,
+                                                 SampleType makeupGain,
+                                                 SampleType mix) {
+  juce::FloatVectorOperations::multiply(wet, makeupGain, numValues);
+
+  // Fully wet: the dry term is exactly zero
+  if constexpr (blended) {
+    juce::FloatVectorOperations::multiply(wet, mix, numValues);
+    juce::FloatVectorOperations::addWithMultiply(wet, dry, SampleType(1) - mix,
+                                                 numValues);
+  } else {
+    juce::ignoreUnused(dry, mix);
+  }
+}
+
+template class FuzzEngine<float>;
+template class FuzzEngine<double>;
+
+} // namespace fuzza
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "Antiderivatives.h"
+#include "DiodeClipperWdf.h"
+#include "SharedResources.h"
+#include "SvfCoefficientTable.h"
+#include "Waveshapers.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace fuzza {
+
+// Block-based fuzz DSP core.
+//
+// The recursive stages (input gate, tone filter, output suppressor) run with
+// the channels of the bus interleaved into juce::dsp::SIMDRegister lanes, so
+// L and R (or a group of surround channels) advance together in a single set
+// of vector instructions. The stateless stages (gain, clipping, makeup, mix)
+// run as block-wide vector passes, so there is no per-sample branching on the
+// clip mode or channel. Channel count is fixed in prepare(), up to 7.1.4.
+//
+// With the gates off, output matches the original per-sample scalar loop to
+// within 1e-6 absolute per sample; all arithmetic is performed in the same
+// order, so differences only come from the compiler's floating-point
+// contraction choices. The gates decide at control rate (see below).
+//
+// Each block runs one kernel specialised at compile time on the clip mode,
+// gate on/off and fully-wet/blended mix, picked from a dispatch table once
+// per block. Fully wet, gate off, hard clip therefore runs as branch-free
+// loops with no dry path at all.
+//
+// At the host rate with a single band and a stateless curve (the common
+// case), the kernel fuses the stages of a channel group into one pass over
+// the samples: input gate, drive, clip, tone filter, makeup, mix and output
+// suppressor. The gate and filter recurrences then overlap in the pipeline
+// instead of each waiting out its own latency across the block. The tanh
+// curves still run as a separate pass over the used channels, as they need
+// a division, and so do the bands of the multiband clipper. The input gate's ramps are decided for the whole block before
+// the pass and the output gate's at the end of each segment inside it.
+// Output is bit-identical to the staged path with the gates off, and shares
+// its segment boundaries with them on.
+//
+// Once the input has stayed below a silence floor for longer than the tail,
+// the engine sleeps: blocks are cleared without running any stage. The first
+// non-silent block wakes it with the gate envelopes advanced by the slept
+// time, so resuming sounds exactly as if it had kept running.
+//
+// Both gates decide at control rate: every 0.25 ms segment counts the
+// samples above the threshold, composes the original attack/release envelope
+// over that many open and closed samples (a short exp() polynomial, branch
+// free across the lanes) and ramps the gain linearly to the result. That
+// keeps the per-sample cost to a compare and a multiply-add; the price is a
+// gate edge up to one segment away from the per-sample reference, which the
+// null test holds to its own budget. The optional hysteresis and hold keep
+// an open gate from chattering.
+//
+// The tone cutoff glides to each new setting over 50 ms, one coefficient step
+// per sample read from a sample-rate-keyed table (no tan() per block or per
+// sample), shared with every other instance at the same rate. A held cutoff
+// uses exact coefficients and a fixed-coefficient filter loop, so sweeping
+// costs about the same as holding.
+//
+// Optionally only the clipper runs oversampled (2x/4x/8x) through cascaded
+// half-band polyphase IIR stages. The dry path is delayed by the same integer
+// latency so the mix stays phase aligned.
+//
+// Alternatively (or additionally) the clipper can run with first- or
+// second-order antiderivative anti-aliasing, which adds no reported latency;
+// see Antiderivatives.h.
+//
+// In multiband mode the clipper input is split by Linkwitz-Riley (LR4)
+// crossovers into up to four bands, each with its own drive and clip curve,
+// and summed again before the tone filter. The bands of one channel share a
+// SIMD register (two registers for doubles), so every crossover section and
+// the clip curve run once for all bands. The lower bands pass through the
+// all-pass of every crossover above them, so the sum of unclipped bands is
+// an all-pass of the input: flat magnitude, no comb filtering. Multiband runs
+// at the oversampled rate when oversampling is on; anti-aliasing does not
+// apply to it.
+//
+// The bands stay in their lanes from the crossovers to the sum, in three
+// passes over a chunk of samples: the crossovers, the clip curves (only the
+// ones some band uses, picked once per block) and the sum of the lanes,
+// which runs as strided loads across the chunk instead of a horizontal add
+// per sample. Each crossover section is in state-space form, so a sample
+// only waits one multiply-add on the section before it.
+//
+// The Muff clip mode is a circuit model rather than a curve: a wave digital
+// filter of a diode clipping stage with its own capacitor state per channel
+// (see DiodeClipperWdf.h). Anti-aliasing does not apply to it; oversampling
+// does, with the circuit solved for the oversampled rate.
+//
+// The engine is templated on the sample type; FuzzEngine<double> serves hosts
+// with a 64-bit mix engine without converting buffers, and keeps its own
+// filter, gate and oversampler state.
+
+// Settings and limits shared by both sample types
+class FuzzEngineBase {
+public:
+  // Largest supported bus (7.1.4)
+  static constexpr int maxChannels = 12;
+
+  // Index into 1x, 2x, 4x, 8x
+  static constexpr int numOversamplingFactors = 4;
+
+  enum ClipMode {
+    hardClip = 0,
+    softClip,
+    asymmetricClip,
+    muffClip, // Circuit model, single-band only
+    numClipModes
+  };
+
+  // TONE range (Hz)
+  static constexpr float minimumToneFrequency = 400.0f;
+  static constexpr float maximumToneFrequency = 8000.0f;
+
+  // Multiband clipping: up to four bands, so three crossovers. Crossover k
+  // ranges from crossoverLimits[k] to crossoverLimits[k + 1] Hz; the ranges
+  // do not overlap, so the bands can never swap places.
+  static constexpr int maxBands = 4;
+  static constexpr std::array<float, maxBands> crossoverLimits{
+      40.0f, 400.0f, 2000.0f, 10000.0f};
+
+  // Per-block parameter snapshot, already mapped to DSP units
+  struct Parameters {
+    float inputGain = 1.0f;     // Linear drive into the clipper
+    float makeupGain = 2.0f;    // Linear auto-level compensation
+    float gateThreshold = 0.0f; // Linear input gate threshold, 0 = gate off
+    float gateHysteresis = 1.0f; // Closing threshold relative to opening
+    float gateHold = 0.0f;      // Seconds a gate stays open after the signal
+                                // drops below the closing threshold
+    float toneFrequency = 2000.0f; // Cutoff the tone filter glides to
+    float mix = 1.0f;           // 0.0 = dry, 1.0 = wet
+    int clipMode = 0;           // ClipMode
+    int oversampling = 0;       // 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x
+    int latencySamples = 0;     // Total latency (host-rate samples) to pad
+                                // the output to when the oversampling
+                                // factor's own is lower
+    waveshaper::Precision precision = waveshaper::Precision::high;
+    waveshaper::Antialiasing antialiasing = waveshaper::Antialiasing::off;
+
+    // Multiband clipping (1 = off, the single clipper above). The band gains
+    // are linear drive on top of inputGain.
+    int numBands = 1;
+    std::array<float, maxBands - 1> crossoverFrequencies{150.0f, 800.0f,
+                                                         3000.0f};
+    std::array<float, maxBands> bandGains{1.0f, 1.0f, 1.0f, 1.0f};
+    std::array<int, maxBands> bandClipModes{}; // ClipMode per band, up to
+                                               // asymmetricClip
+  };
+
+  // How long the output keeps decaying after the input stops (the output
+  // suppressor release)
+  static double getTailLengthSeconds();
+};
+
+template <typename SampleType> class FuzzEngine : public FuzzEngineBase {
+public:
+  using Lanes = juce::dsp::SIMDRegister<SampleType>;
+
+  // Channels are processed in groups of one register's worth of lanes
+  static constexpr int lanesPerGroup = static_cast<int>(Lanes::SIMDNumElements);
+  static_assert(lanesPerGroup >= 2, "stereo must fit into one SIMD register");
+
+  // Multiband: the bands of one channel are packed into lanes
+  static constexpr int numBandRegisters =
+      (maxBands + lanesPerGroup - 1) / lanesPerGroup;
+
+  // Sizes all per-channel state and scratch for the bus; may allocate
+  void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+
+  // Back to rest: all state cleared, gates closed, and the next cutoff is
+  // taken without a glide. Does not allocate.
+  void reset();
+
+  // Takes over the gate envelopes and the tone filter (state and cutoff
+  // glide) of another engine prepared alike, as if this one had been running
+  // instead. Everything else is left as it is. Does not allocate.
+  void continueFrom(const FuzzEngine &other);
+
+  int getNumChannels() const { return preparedChannels; }
+
+  // Latency (host-rate samples) added by the given oversampling setting
+  int getLatencySamples(int oversampling) const;
+
+  bool isSleeping() const { return sleeping; }
+
+  // Telemetry for the last process() call
+  int getNumClippedSamples() const { return clippedSamples; }
+  // Lowest gate gain across the processed channels (1 = no gain reduction)
+  float getInputGateGain() const { return getLowestGain(state.inputGate); }
+  float getOutputGateGain() const { return getLowestGain(state.outputGate); }
+
+  void process(juce::AudioBuffer<SampleType> &buffer, int numChannels,
+               const Parameters &params);
+
+private:
+  using Kernel = void (FuzzEngine::*)(juce::AudioBuffer<SampleType> &, int,
+                                      int, int, const Parameters &);
+
+  // Gate state of one channel group
+  struct GateLanes {
+    Lanes gain; // Envelope (gain applied to the last sample)
+    Lanes open; // 1 while open, 0 while closed
+    Lanes hold; // Samples left before an open gate may close
+  };
+
+  // Per-channel state as structure-of-arrays: element g of each array holds
+  // the lanes of channel group g, so a group loads with aligned reads.
+  struct ChannelState {
+    std::vector<Lanes> toneS1, toneS2;
+    std::vector<GateLanes> inputGate, outputGate;
+
+    void resize(int numGroups);
+    void reset();
+  };
+
+  // Crossover filter state of one channel: two sections per crossover, one
+  // register of bands each
+  static constexpr int numBandSections = 2 * (maxBands - 1);
+  using BandState = std::array<Lanes, numBandSections * numBandRegisters>;
+
+  // One Butterworth TPT state variable section of a crossover, written in
+  // terms of v = x - (g + R2) s1 - s2 (the high-pass before its gain h):
+  // s1 moves by v * 2gh, s2 by v * 2g^2h + s1 * 2g, and each lane outputs
+  // its own mix of the section (low-pass, high-pass, all-pass
+  // LP - R2 BP + HP, or straight through) as v * ov + s1 * oa + s2 * ob.
+  struct BandSection {
+    Lanes gPlusR2, s1v, s2v, s2s1;
+    std::array<Lanes, numBandRegisters> ov, oa, ob;
+  };
+
+  // Clip curves some band uses: the hard clip (Hard, and Asymmetric below
+  // zero) and tanh (Soft, and Asymmetric above zero)
+  struct BandCurves {
+    bool hard = true, shaped = false;
+  };
+
+  // Envelope coefficients of one gate stage: the per-sample release (for
+  // waking from sleep) and the logs of both per-sample coefficients
+  struct GateCoefficients {
+    SampleType release = 0, logAttack = 0, logRelease = 0;
+  };
+
+  // Loop-invariant lanes of one gate stage for the current block
+  struct GateConstants {
+    Lanes openThreshold, closeThreshold, holdSamples, logAttack, logRelease;
+  };
+
+  // Samples of one gate segment above the opening and the closing threshold
+  struct GateCounts {
+    Lanes aboveOpen, aboveClose;
+  };
+
+  // Gain ramp of one gate segment: start + step * position, position 1 at
+  // the segment's first sample
+  struct GateSegment {
+    Lanes start, step;
+  };
+
+  static Kernel selectKernel(int clipMode, bool gateEnabled, bool blended);
+
+  // Sleep mode
+  static bool isSilent(const juce::AudioBuffer<SampleType> &buffer,
+                       int numChannels, const Parameters &params);
+  void wakeUp();
+  void holdGatesOpen();
+
+  float getLowestGain(const std::vector<GateLanes> &gates) const;
+  static int countClippedSamples(const SampleType *data, int numSamples);
+
+  template <int clipMode, bool gateEnabled, bool blended>
+  void processKernel(juce::AudioBuffer<SampleType> &buffer, int startSample,
+                     int numSamples, int numChannels, const Parameters &params);
+  // Host rate, single band, stateless curve: all stages of a channel group in
+  // one pass over the samples
+  template <int clipMode, bool gateEnabled, bool blended, bool ramping>
+  void processFused(juce::AudioBuffer<SampleType> &buffer, int startSample,
+                    int numSamples, int numChannels, const Parameters &params);
+
+  void updateToneCoefficients(float frequency);
+  void setToneTarget(float frequency);
+  bool fillToneRamp(int numSamples);
+
+  // Lane <-> channel shuffles for one channel group
+  static void gather(const juce::AudioBuffer<SampleType> &buffer,
+                     int startSample, int numSamples, int group,
+                     int numChannels, Lanes *dest);
+  static void scatter(const Lanes *source, int numSamples, int group,
+                      int numChannels, juce::AudioBuffer<SampleType> &buffer,
+                      int startSample);
+
+  // Recursive stages (one channel group per instruction)
+  GateConstants makeGateConstants(SampleType threshold,
+                                  const Parameters &params,
+                                  const GateCoefficients &coefficients) const;
+  template <bool hysteresis>
+  static void countGateSample(Lanes input, const GateConstants &constants,
+                              GateCounts &counts);
+  static GateSegment startGateSegment(GateLanes &gate,
+                                      const GateCounts &counts,
+                                      int numSamples,
+                                      const GateConstants &constants);
+  static Lanes applyGate(Lanes input, const GateSegment &segment,
+                         Lanes position);
+  // Counts and decides every gate segment of a block, returning the ramps
+  const GateSegment *decideGate(const Lanes *data, int numSamples,
+                                GateLanes &gate, const GateConstants &constants,
+                                bool hysteresis);
+  void processGate(Lanes *data, int numSamples, GateLanes &gate,
+                   SampleType threshold, const Parameters &params,
+                   const GateCoefficients &coefficients);
+  static Lanes processToneSample(Lanes input, Lanes &s1, Lanes &s2, Lanes g,
+                                 Lanes h, Lanes gPlusR2);
+  template <bool ramping>
+  void processToneFilter(Lanes *data, int numSamples, Lanes &toneS1,
+                         Lanes &toneS2);
+
+  // Stateless stages (block-wide vector passes)
+  template <int clipMode>
+  void processClipStage(juce::AudioBuffer<SampleType> &buffer, int startSample,
+                        int numSamples, int numChannels,
+                        const Parameters &params);
+  void delayDry(int numGroups, int numSamples, int delaySamples);
+  template <int clipMode>
+  static void processClipper(SampleType *data, int numSamples,
+                             const Parameters &params,
+                             waveshaper::AntialiasingState &history);
+  void processCircuit(SampleType *data, int numSamples,
+                      const Parameters &params, SampleType &capacitorState) const;
+  // Multiband clipper (per channel, bands across lanes)
+  void updateBands(const Parameters &params);
+  void resetBands();
+  void processMultiband(SampleType *data, int numSamples, size_t channel,
+                        waveshaper::Precision precision);
+  template <waveshaper::Precision precision>
+  void processBands(SampleType *data, int numSamples, BandState &s1,
+                    BandState &s2) const;
+  template <int numSections>
+  void splitBands(const SampleType *input, Lanes *bands, int numSamples,
+                  int numRegisters, BandState &s1, BandState &s2) const;
+  template <waveshaper::Precision precision, bool hard, bool shaped>
+  void clipBands(const Lanes *bands, SampleType *values, int numSamples,
+                 int numRegisters) const;
+  void delayOutput(juce::AudioBuffer<SampleType> &buffer, int numChannels,
+                   int delaySamples);
+  template <bool blended>
+  static void processMakeupAndMix(SampleType *wet, const SampleType *dry,
+                                  int numValues, SampleType makeupGain,
+                                  SampleType mix);
+
+  double sampleRate = 44100.0;
+  int maximumBlockSize = 0;
+  int preparedChannels = 0;
+  int numGroups = 0; // Channel groups of lanesPerGroup channels
+
+  // Gate coefficients (constant for a given sample rate)
+  // Input Gate: Tight and Fast (removes noise before distortion)
+  GateCoefficients inputGateCoefficients;
+  // Output Suppressor: Smooth and Long (preserves sustain)
+  GateCoefficients outputGateCoefficients;
+  // Samples per gate decision, the ramp positions 1..gateInterval and
+  // scratch for the counts and ramps of one block's segments
+  int gateInterval = 1;
+  std::vector<Lanes> gateRamp;
+  std::vector<GateCounts> gateCounts;
+  std::vector<GateSegment> gateSegments;
+
+  // Tone filter coefficients (TPT state variable low-pass) for the held
+  // cutoff
+  float toneFrequency = -1.0f;
+  SampleType toneG = 0, toneR2 = 0, toneH = 0;
+
+  // Cutoff glide: table position moving linearly to the target, expanded to
+  // per-sample coefficients once per block and shared by every group
+  std::shared_ptr<const SvfCoefficientTable<SampleType>> toneTable;
+  float toneTarget = -1.0f;
+  float tonePosition = 0.0f, toneTargetPosition = 0.0f, toneStep = 0.0f;
+  int toneRampLength = 0, toneRampSamples = 0;
+  std::vector<SampleType> toneRampG, toneRampH;
+
+  // Tone filter and gate envelope state for every channel. The gate gains are
+  // held fully open while the gate is off.
+  ChannelState state;
+
+  // Interleaved scratch: gated dry signal (one block per group, kept until
+  // the mix) and wet signal (reused group by group)
+  std::vector<Lanes> dryLanes, wetLanes;
+
+  // Clipper oversampling (index 0 = 2x), preallocated in prepare()
+  std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>,
+             numOversamplingFactors - 1>
+      oversamplers;
+  int activeOversampling = 0;
+
+  // Clipper input history per channel for antiderivative anti-aliasing, at
+  // the active oversampling rate
+  std::vector<waveshaper::AntialiasingState> antialiasingState;
+  waveshaper::Antialiasing activeAntialiasing = waveshaper::Antialiasing::off;
+
+  // Muff circuit solved for the rate of each oversampling factor (shared
+  // between engines), and its capacitor state per channel
+  std::array<std::shared_ptr<const DiodeClipperWdf<SampleType>>,
+             numOversamplingFactors>
+      circuits;
+  std::vector<SampleType> circuitState;
+
+  // Multiband crossover state per channel and the coefficients for the
+  // crossovers and rate below (recomputed when either changes)
+  std::vector<BandState> bandS1, bandS2;
+  std::array<BandSection, numBandSections> bandSections;
+  std::array<Lanes, numBandRegisters> bandDrive, bandTanhDrive;
+  std::array<typename Lanes::vMaskType, numBandRegisters> bandSoftMask,
+      bandAsymmetricMask;
+  BandCurves bandCurves;
+  std::array<float, maxBands - 1> bandFrequencies{};
+  double bandRate = 0.0;
+  int activeBands = 1;
+
+  // Telemetry
+  int activeChannels = 0;
+  int clippedSamples = 0;
+
+  // Sleep mode state
+  juce::int64 silentSamples = 0; // Consecutive silent input samples
+  juce::int64 sleptSamples = 0;
+  bool sleeping = false;
+
+  // Dry path delay matching the oversampler latency, one line per group
+  std::vector<Lanes> dryDelayLine;
+  int dryDelayLength = 0;
+  int dryDelayPosition = 0;
+
+  // Output padding up to Parameters::latencySamples, one line per channel
+  // (dryDelayLength long)
+  std::vector<SampleType> outputDelayLine;
+  int outputDelay = 0;
+  int outputDelayPosition = 0;
+};
+
+} // namespace fuzza
@@ -0,0 +1,48 @@
+#include "SharedResources.h"
+
+namespace fuzza {
+
+std::mutex SharedResources::mutex;
+std::map<SharedResources::Key, SharedResources::Entry> SharedResources::entries;
+
+std::shared_ptr<const void>
+SharedResources::getOrCreate(const Key &key,
+                             const std::function<Created()> &create) {
+  const std::lock_guard<std::mutex> lock(mutex);
+
+  // Drop entries whose last holder has gone
+  for (auto it = entries.begin(); it != entries.end();)
+    it = it->second.resource.expired() ? entries.erase(it) : std::next(it);
+
+  auto &entry = entries[key];
+
+  if (auto existing = entry.resource.lock())
+    return existing;
+
+  // Built under the lock, so concurrent first users build it only once
+  auto created = create();
+  entry.resource = created.first;
+  entry.size = created.second;
+  return created.first;
+}
+
+SharedResources::Statistics SharedResources::getStatistics() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  Statistics statistics;
+
+  for (const auto &[key, entry] : entries) {
+    const auto holders = entry.resource.use_count();
+
+    if (holders == 0)
+      continue;
+
+    ++statistics.numResources;
+    statistics.numReferences += static_cast<int>(holders);
+    statistics.bytes += entry.size;
+    statistics.bytesSaved += static_cast<size_t>(holders - 1) * entry.size;
+  }
+
+  return statistics;
+}
+
+} // namespace fuzza
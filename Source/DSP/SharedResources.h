@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <utility>
+
+namespace fuzza {
+
+// Process-wide cache of immutable DSP resources (waveshaper tables,
+// sample-rate-keyed coefficient sets), shared read-only by every plugin
+// instance in the process.
+//
+// The first instance to ask for a resource type with a given key builds it;
+// later ones get the same object. Each holder keeps a reference, and the
+// resource is freed when the last holder lets go of it, so memory stays flat
+// however many instances a session loads. get() locks, so call it from
+// prepare(), never from the audio thread; reading a resource needs no lock,
+// since it never changes after it is built.
+class SharedResources {
+public:
+  // Returns the resource of this type and key, building it with create()
+  // (returning a Resource by value) if no instance holds one. Resource
+  // provides getSizeInBytes() for the statistics.
+  template <typename Resource, typename Create>
+  static std::shared_ptr<const Resource> get(const juce::String &key,
+                                             Create &&create) {
+    auto resource = getOrCreate({std::type_index(typeid(Resource)), key}, [&] {
+      auto created = std::make_shared<Resource>(create());
+      const auto size = created->getSizeInBytes();
+      return std::make_pair(std::shared_ptr<const void>(std::move(created)),
+                            size);
+    });
+
+    return std::static_pointer_cast<const Resource>(resource);
+  }
+
+  // Debug counter: how much is shared right now
+  struct Statistics {
+    int numResources = 0;  // Distinct live resources
+    int numReferences = 0; // Holders across all instances
+    size_t bytes = 0;      // Memory the resources take
+    size_t bytesSaved = 0; // Memory per-holder copies would take on top
+  };
+
+  static Statistics getStatistics();
+
+private:
+  using Key = std::pair<std::type_index, juce::String>;
+  using Created = std::pair<std::shared_ptr<const void>, size_t>;
+
+  struct Entry {
+    std::weak_ptr<const void> resource;
+    size_t size = 0;
+  };
+
+  static std::shared_ptr<const void>
+  getOrCreate(const Key &key, const std::function<Created()> &create);
+
+  static std::mutex mutex;
+  static std::map<Key, Entry> entries;
+};
+
+} // namespace fuzza
@@ -0,0 +1,61 @@
+#include "Telemetry.h"
+
+namespace fuzza {
+
+void Telemetry::prepare(double newSampleRate) {
+  sampleRate = newSampleRate;
+}
+
+void Telemetry::publish(BlockTelemetry block) {
+  if (block.numSamples > 0)
+    block.load = static_cast<float>(block.processingSeconds * sampleRate /
+                                    block.numSamples);
+
+  auto bin = juce::jlimit(0, numLoadBins - 1,
+                          static_cast<int>(block.load / loadBinWidth));
+  loadHistogram[static_cast<size_t>(bin)].fetch_add(1,
+                                                    std::memory_order_relaxed);
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+  if (size1 == 0) {
+    numDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  blocks[static_cast<size_t>(start1)] = block;
+  fifo.finishedWrite(1);
+}
+
+bool Telemetry::pop(BlockTelemetry &block) {
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(1, start1, size1, start2, size2);
+
+  if (size1 == 0)
+    return false;
+
+  block = blocks[static_cast<size_t>(start1)];
+  fifo.finishedRead(1);
+  return true;
+}
+
+Telemetry::LoadHistogram Telemetry::getLoadHistogram() const {
+  LoadHistogram histogram;
+
+  for (size_t bin = 0; bin < histogram.size(); ++bin)
+    histogram[bin] = loadHistogram[bin].load(std::memory_order_relaxed);
+
+  return histogram;
+}
+
+void Telemetry::resetLoadHistogram() {
+  for (auto &count : loadHistogram)
+    count.store(0, std::memory_order_relaxed);
+}
+
+juce::uint32 Telemetry::getNumDroppedBlocks() const {
+  return numDroppedBlocks.load(std::memory_order_relaxed);
+}
+
+} // namespace fuzza
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+namespace fuzza {
+
+// What the audio thread measured for one processed block
+struct BlockTelemetry {
+  float inputPeak = 0.0f, inputRms = 0.0f;   // Loudest channel, linear
+  float outputPeak = 0.0f, outputRms = 0.0f; // Loudest channel, linear
+  float inputGateGain = 1.0f;  // Most-closed channel, 1 = no gain reduction
+  float outputGateGain = 1.0f; // Most-closed channel, 1 = no gain reduction
+  int clippedSamples = 0;      // Clipper input samples beyond +-1
+  int numSamples = 0;
+  float processingSeconds = 0.0f;
+  float load = 0.0f; // Processing time / block duration
+  int qualityTier = -1; // QualityGovernor tier the block ran at, -1 = manual
+};
+
+// Lock-free telemetry surface between the audio thread and one observer.
+//
+// The audio thread publishes one BlockTelemetry per block into a
+// single-producer/single-consumer ring (juce::AbstractFifo): publishing is
+// wait-free and never allocates; if the observer falls behind, blocks are
+// dropped and counted instead of blocking. Exactly one thread (normally the
+// editor's timer on the message thread) may drain the ring.
+//
+// Every block's load also lands in a histogram of atomic counters that any
+// thread can read, so outlier blocks in long sessions remain visible after
+// the ring has been drained.
+class Telemetry {
+public:
+  // Blocks buffered for the observer (several seconds at small block sizes
+  // for a UI draining at 30 Hz)
+  static constexpr int capacity = 1024;
+
+  // Load histogram: 5 % of the block deadline per bin, the last bin collects
+  // everything from 195 % up
+  static constexpr int numLoadBins = 40;
+  static constexpr float loadBinWidth = 0.05f;
+
+  using LoadHistogram = std::array<juce::uint32, numLoadBins>;
+
+  // Call from prepareToPlay, before the audio thread publishes
+  void prepare(double sampleRate);
+
+  // Audio thread only. Fills in block.load from the processing time.
+  void publish(BlockTelemetry block);
+
+  // Observer thread only. Returns false once the ring is empty.
+  bool pop(BlockTelemetry &block);
+
+  // Any thread
+  LoadHistogram getLoadHistogram() const;
+  void resetLoadHistogram();
+  juce::uint32 getNumDroppedBlocks() const;
+
+private:
+  double sampleRate = 44100.0;
+
+  juce::AbstractFifo fifo{capacity};
+  std::array<BlockTelemetry, capacity> blocks;
+
+  std::array<std::atomic<juce::uint32>, numLoadBins> loadHistogram{};
+  std::atomic<juce::uint32> numDroppedBlocks{0};
+};
+
+} // namespace fuzza
@@ -0,0 +1,82 @@
+#include "LevelMeter.h"
+
+namespace {
+// Changes smaller than this (fraction of the meter height) are not repainted
+const float repaintThreshold = 0.005f;
+
+bool hasMoved(float oldValue, float newValue) {
+  return std::abs(oldValue - newValue) > repaintThreshold;
+}
+} // namespace
+
+LevelMeter::LevelMeter() {
+  setOpaque(false);
+  setInterceptsMouseClicks(false, false);
+}
+
+float LevelMeter::toProportion(float gain) {
+  auto decibels = juce::Decibels::gainToDecibels(gain, minimumDecibels);
+  return juce::jlimit(0.0f, 1.0f, 1.0f - decibels / minimumDecibels);
+}
+
+void LevelMeter::setLevels(float peak, float rms) {
+  auto newPeak = toProportion(peak);
+  auto newRms = toProportion(rms);
+
+  if (hasMoved(peakLevel, newPeak) || hasMoved(rmsLevel, newRms)) {
+    peakLevel = newPeak;
+    rmsLevel = newRms;
+    repaint();
+  }
+}
+
+void LevelMeter::setGainReduction(float gateGain) {
+  auto decibels = -juce::Decibels::gainToDecibels(
+      gateGain, -maximumGainReductionDecibels);
+  auto newGainReduction =
+      juce::jlimit(0.0f, 1.0f, decibels / maximumGainReductionDecibels);
+
+  if (hasMoved(gainReduction, newGainReduction)) {
+    gainReduction = newGainReduction;
+    repaint();
+  }
+}
+
+void LevelMeter::setClipping(bool isClipping) {
+  if (clipping != isClipping) {
+    clipping = isClipping;
+    repaint();
+  }
+}
+
+void LevelMeter::paint(juce::Graphics &g) {
+  auto bounds = getLocalBounds().toFloat();
+
+  // Clip LED
+  auto led = bounds.removeFromTop(bounds.getWidth()).reduced(1.0f);
+  g.setColour(clipping ? juce::Colour(0xffdd0000) : juce::Colour(0xff442222));
+  g.fillEllipse(led);
+  bounds.removeFromTop(4.0f);
+
+  // Meter well
+  g.setColour(juce::Colour(0xff111111));
+  g.fillRoundedRectangle(bounds, 3.0f);
+
+  auto bar = bounds.reduced(2.0f);
+
+  // RMS bar (orange) with a white peak line
+  g.setColour(juce::Colour(0xffff9500));
+  g.fillRect(bar.withTop(bar.getBottom() - bar.getHeight() * rmsLevel));
+
+  if (peakLevel > 0.0f) {
+    auto peakY = bar.getBottom() - bar.getHeight() * peakLevel;
+    g.setColour(juce::Colours::white);
+    g.fillRect(bar.getX(), peakY, bar.getWidth(), 1.5f);
+  }
+
+  // Gate gain reduction (red, from the top)
+  if (gainReduction > 0.0f) {
+    g.setColour(juce::Colour(0xaadd0000));
+    g.fillRect(bar.withHeight(bar.getHeight() * gainReduction));
+  }
+}
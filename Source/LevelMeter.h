@@ -0,0 +1,31 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+// Vertical pedal-style meter: RMS bar with a peak line, gate gain reduction
+// hanging from the top and a clip LED above the bar.
+class LevelMeter : public juce::Component {
+public:
+  LevelMeter();
+
+  // Linear values; repaints only when the drawn result changes
+  void setLevels(float peak, float rms);
+  void setGainReduction(float gateGain);
+  void setClipping(bool isClipping);
+
+  void paint(juce::Graphics &) override;
+
+private:
+  // Meter range
+  static constexpr float minimumDecibels = -60.0f;
+  static constexpr float maximumGainReductionDecibels = 40.0f;
+
+  static float toProportion(float gain);
+
+  float peakLevel = 0.0f;
+  float rmsLevel = 0.0f;
+  float gainReduction = 0.0f; // 0..1 of the gain reduction range
+  bool clipping = false;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeter)
+};
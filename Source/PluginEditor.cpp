@@ -1,8 +1,27 @@
 #include "PluginEditor.h"
 #include "PluginProcessor.h"
 
+namespace {
+// Meter refresh and ballistics
+const int meterRefreshRate = 30;  // Hz
+const float meterFallOff = 0.85f; // Per frame (~40 dB/s)
+const int clipHoldLength = 15;    // Frames (500 ms)
+
+// Meter placement in the side margins
+const int meterInset = 7;
+const int meterWidth = 11;
+const int meterTop = 100;
+
+// Analyzer strip below the footswitch
+const int analyzerHeight = 80;
+
+// Layout size; the editor scales from 75 % to 200 % of it
+const int designWidth = 520;
+const int designHeight = 720;
+} // namespace
+
 FuzzaAudioProcessorEditor::FuzzaAudioProcessorEditor(FuzzaAudioProcessor &p)
-    : AudioProcessorEditor(&p), audioProcessor(p) {
+    : AudioProcessorEditor(&p), audioProcessor(p), analyzer(p.analyzerTap) {
 
   // === KNOBS (3x rotary) ===
   auto setupKnob = [this](juce::Slider& slider, juce::Label& label,
@@ -14,13 +33,13 @@ FuzzaAudioProcessorEditor::FuzzaAudioProcessorEditor(FuzzaAudioProcessor &p)
     slider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::white);
     slider.setColour(juce::Slider::textBoxBackgroundColourId, juce::Colour(0x00000000)); // Transparent
     slider.setColour(juce::Slider::textBoxOutlineColourId, juce::Colour(0x00000000)); // Remove border
-    addAndMakeVisible(slider);
+    content.addAndMakeVisible(slider);
 
     label.setText(labelText, juce::dontSendNotification);
     label.setJustificationType(juce::Justification::centred);
     label.setColour(juce::Label::textColourId, juce::Colours::white);
     label.setFont(juce::FontOptions(18.0f, juce::Font::bold)); // Increased to 18 for better readability
-    addAndMakeVisible(label);
+    content.addAndMakeVisible(label);
   };
 
   setupKnob(gainSlider, gainLabel, "GAIN");
@@ -43,21 +62,39 @@ FuzzaAudioProcessorEditor::FuzzaAudioProcessorEditor(FuzzaAudioProcessor &p)
     button.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
     button.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
     button.onClick = [this, preset]() {
-      audioProcessor.apvts.getParameter("TONE_PRESET")->setValueNotifyingHost(preset / 2.0f);
-      updateToneButtons(preset);
+      // Jump the continuous TONE parameter to the preset's cutoff
+      auto* param = audioProcessor.apvts.getParameter("TONE");
+      auto frequency = FuzzaAudioProcessor::tonePresetFrequencies[static_cast<size_t>(preset)];
+      param->setValueNotifyingHost(param->convertTo0to1(frequency));
+      updateToneButtons();
     };
-    addAndMakeVisible(button);
+    content.addAndMakeVisible(button);
   };
 
   setupToneButton(toneWarmButton, "WARM", 0);
   setupToneButton(toneBalancedButton, "BALANCED", 1);
   setupToneButton(toneBrightButton, "BRIGHT", 2);
 
+  // Any cutoff between the presets; the buttons light when it sits on one
+  toneSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+  toneSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 80, 20);
+  toneSlider.setColour(juce::Slider::trackColourId, juce::Colour(0xffff9500)); // Orange
+  toneSlider.setColour(juce::Slider::backgroundColourId, juce::Colour(0xff3a3a3a));
+  toneSlider.setColour(juce::Slider::thumbColourId, juce::Colours::white);
+  toneSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::white);
+  toneSlider.setColour(juce::Slider::textBoxBackgroundColourId, juce::Colour(0x00000000)); // Transparent
+  toneSlider.setColour(juce::Slider::textBoxOutlineColourId, juce::Colour(0x00000000)); // Remove border
+  toneSlider.onValueChange = [this]() { updateToneButtons(); };
+  content.addAndMakeVisible(toneSlider);
+
+  toneAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+      audioProcessor.apvts, "TONE", toneSlider);
+
   toneLabel.setText("TONE", juce::dontSendNotification);
   toneLabel.setJustificationType(juce::Justification::centred);
   toneLabel.setColour(juce::Label::textColourId, juce::Colours::white);
   toneLabel.setFont(juce::FontOptions(14.0f, juce::Font::bold));
-  addAndMakeVisible(toneLabel);
+  content.addAndMakeVisible(toneLabel);
 
   // === CLIPPING MODE BUTTONS ===
   auto setupClipButton = [this](juce::TextButton& button, const juce::String& text, int mode) {
@@ -68,25 +105,47 @@ FuzzaAudioProcessorEditor::FuzzaAudioProcessorEditor(FuzzaAudioProcessor &p)
     button.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
     button.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
     button.onClick = [this, mode]() {
-      // Directly set the choice index (0, 1, or 2)
+      // Directly set the choice index (0 to 3)
       auto* param = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("CLIP_MODE"));
       if (param) {
         *param = mode;
       }
-      updateClipButtons(mode);
+      updateClipButtons();
     };
-    addAndMakeVisible(button);
+    content.addAndMakeVisible(button);
   };
 
   setupClipButton(clipHardButton, "HARD", 0);
   setupClipButton(clipSoftButton, "SOFT", 1);
   setupClipButton(clipAsymButton, "ASYM", 2);
+  setupClipButton(clipMuffButton, "MUFF", 3);
 
   clipLabel.setText("CLIPPING", juce::dontSendNotification);
   clipLabel.setJustificationType(juce::Justification::centred);
   clipLabel.setColour(juce::Label::textColourId, juce::Colours::white);
   clipLabel.setFont(juce::FontOptions(14.0f, juce::Font::bold));
-  addAndMakeVisible(clipLabel);
+  content.addAndMakeVisible(clipLabel);
+
+  // === ANTI-ALIASING SELECTOR (next to the clip modes) ===
+  // Items in the parameter's choice order, before the attachment syncs it
+  if (auto* param = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("ANTIALIAS")))
+    antialiasBox.addItemList(param->choices, 1);
+
+  antialiasBox.setJustificationType(juce::Justification::centred);
+  antialiasBox.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff3a3a3a));
+  antialiasBox.setColour(juce::ComboBox::textColourId, juce::Colours::white);
+  antialiasBox.setColour(juce::ComboBox::arrowColourId, juce::Colour(0xffff9500)); // Orange
+  antialiasBox.setColour(juce::ComboBox::outlineColourId, juce::Colour(0x00000000)); // Remove border
+  content.addAndMakeVisible(antialiasBox);
+
+  antialiasAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+      audioProcessor.apvts, "ANTIALIAS", antialiasBox);
+
+  antialiasLabel.setText("ANTI-ALIAS", juce::dontSendNotification);
+  antialiasLabel.setJustificationType(juce::Justification::centred);
+  antialiasLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+  antialiasLabel.setFont(juce::FontOptions(14.0f, juce::Font::bold));
+  content.addAndMakeVisible(antialiasLabel);
 
   // === BYPASS FOOTSWITCH ===
   bypassButton.setButtonText("BYPASS");
@@ -95,35 +154,178 @@ FuzzaAudioProcessorEditor::FuzzaAudioProcessorEditor(FuzzaAudioProcessor &p)
   bypassButton.setColour(juce::TextButton::buttonOnColourId, juce::Colour(0xffdd0000)); // Red when on
   bypassButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
   bypassButton.setColour(juce::TextButton::textColourOnId, juce::Colours::white);
-  addAndMakeVisible(bypassButton);
+  content.addAndMakeVisible(bypassButton);
 
   bypassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
       audioProcessor.apvts, "BYPASS", bypassButton);
 
+  // === CABINET ===
+  cabinetButton.setButtonText("CAB");
+  cabinetButton.setClickingTogglesState(true);
+  cabinetButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xff3a3a3a));
+  cabinetButton.setColour(juce::TextButton::buttonOnColourId, juce::Colour(0xffff9500)); // Orange when on
+  cabinetButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+  cabinetButton.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
+  content.addAndMakeVisible(cabinetButton);
+
+  cabinetAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+      audioProcessor.apvts, "CABINET", cabinetButton);
+
+  impulseResponseButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xff3a3a3a));
+  impulseResponseButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+  impulseResponseButton.onClick = [this]() {
+    impulseResponseChooser = std::make_unique<juce::FileChooser>(
+        "Load cabinet IR", audioProcessor.getImpulseResponseFile(), "*.wav;*.aif;*.aiff");
+
+    impulseResponseChooser->launchAsync(
+        juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& chooser) {
+          auto file = chooser.getResult();
+
+          if (file != juce::File())
+            audioProcessor.loadImpulseResponse(file);
+
+          updateImpulseResponseButton();
+        });
+  };
+  content.addAndMakeVisible(impulseResponseButton);
+
+  // === METERS ===
+  content.addAndMakeVisible(inputMeter);
+  content.addAndMakeVisible(outputMeter);
+
+  // === ANALYZER ===
+  content.addAndMakeVisible(analyzer);
+
   // Initialize button states
-  updateToneButtons(1); // Balanced default
-  updateClipButtons(0); // Hard default
+  updateToneButtons(); // From the current TONE
+  updateClipButtons(); // From the current CLIP_MODE
+  updateImpulseResponseButton();
+
+  // Controls are laid out at the design size; the content component is
+  // scaled as a whole, so everything stays vector-sharp at any size
+  content.setInterceptsMouseClicks(false, true);
+  addAndMakeVisible(content);
+
+  // The static enclosure is cached, so the editor paints opaquely from it
+  setOpaque(true);
+
+  setResizable(true, true);
+  setResizeLimits(designWidth * 3 / 4, designHeight * 3 / 4, designWidth * 2,
+                  designHeight * 2);
+  getConstrainer()->setFixedAspectRatio(static_cast<double>(designWidth) /
+                                        designHeight);
+  setSize(designWidth, designHeight);
+
+  startTimerHz(meterRefreshRate);
+}
+
+FuzzaAudioProcessorEditor::~FuzzaAudioProcessorEditor() { stopTimer(); }
+
+void FuzzaAudioProcessorEditor::timerCallback() {
+  // Everything the audio thread published since the last frame
+  fuzza::BlockTelemetry block;
+  float framePeakIn = 0.0f, frameRmsIn = 0.0f;
+  float framePeakOut = 0.0f, frameRmsOut = 0.0f;
+  float inputGateGain = 1.0f, outputGateGain = 1.0f;
+  int clippedSamples = 0;
+
+  while (audioProcessor.telemetry.pop(block)) {
+    framePeakIn = juce::jmax(framePeakIn, block.inputPeak);
+    frameRmsIn = juce::jmax(frameRmsIn, block.inputRms);
+    framePeakOut = juce::jmax(framePeakOut, block.outputPeak);
+    frameRmsOut = juce::jmax(frameRmsOut, block.outputRms);
+    inputGateGain = juce::jmin(inputGateGain, block.inputGateGain);
+    outputGateGain = juce::jmin(outputGateGain, block.outputGateGain);
+    clippedSamples += block.clippedSamples;
+  }
+
+  // Instant attack, exponential fall-off
+  auto fall = [](float displayed, float measured) {
+    return juce::jmax(measured, displayed * meterFallOff);
+  };
+
+  inputPeak = fall(inputPeak, framePeakIn);
+  inputRms = fall(inputRms, frameRmsIn);
+  outputPeak = fall(outputPeak, framePeakOut);
+  outputRms = fall(outputRms, frameRmsOut);
+
+  clipHoldFrames = clippedSamples > 0 ? clipHoldLength
+                                      : juce::jmax(0, clipHoldFrames - 1);
+
+  inputMeter.setLevels(inputPeak, inputRms);
+  inputMeter.setGainReduction(inputGateGain);
+  inputMeter.setClipping(clipHoldFrames > 0);
+
+  outputMeter.setLevels(outputPeak, outputRms);
+  outputMeter.setGainReduction(outputGateGain);
+
+  analyzer.refresh();
 
-  setSize(520, 570);
+  // TONE and CLIP_MODE may be automated, set by the host or restored with a
+  // session (or a program), the IR restored with a session
+  updateToneButtons();
+  updateClipButtons();
+  updateImpulseResponseButton();
 }
 
-FuzzaAudioProcessorEditor::~FuzzaAudioProcessorEditor() {}
+void FuzzaAudioProcessorEditor::updateToneButtons() {
+  // Lights the preset TONE sits on; none while it is in between
+  auto frequency = audioProcessor.apvts.getRawParameterValue("TONE")->load();
+  int selectedPreset = -1;
+
+  for (size_t i = 0; i < FuzzaAudioProcessor::tonePresetFrequencies.size(); ++i)
+    if (std::abs(frequency - FuzzaAudioProcessor::tonePresetFrequencies[i]) < 1.0f)
+      selectedPreset = static_cast<int>(i);
 
-void FuzzaAudioProcessorEditor::updateToneButtons(int selectedPreset) {
   toneWarmButton.setToggleState(selectedPreset == 0, juce::dontSendNotification);
   toneBalancedButton.setToggleState(selectedPreset == 1, juce::dontSendNotification);
   toneBrightButton.setToggleState(selectedPreset == 2, juce::dontSendNotification);
 }
 
-void FuzzaAudioProcessorEditor::updateClipButtons(int selectedMode) {
+void FuzzaAudioProcessorEditor::updateClipButtons() {
+  auto selectedMode = juce::roundToInt(
+      audioProcessor.apvts.getRawParameterValue("CLIP_MODE")->load());
+
   clipHardButton.setToggleState(selectedMode == 0, juce::dontSendNotification);
   clipSoftButton.setToggleState(selectedMode == 1, juce::dontSendNotification);
   clipAsymButton.setToggleState(selectedMode == 2, juce::dontSendNotification);
+  clipMuffButton.setToggleState(selectedMode == 3, juce::dontSendNotification);
+}
+
+void FuzzaAudioProcessorEditor::updateImpulseResponseButton() {
+  auto file = audioProcessor.getImpulseResponseFile();
+  impulseResponseButton.setButtonText(
+      file == juce::File() ? "LOAD IR" : file.getFileNameWithoutExtension());
 }
 
 void FuzzaAudioProcessorEditor::paint(juce::Graphics &g) {
+  // Re-render the enclosure only when the size or display scale changed
+  auto pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+  if (background.isNull() || pixelScale != backgroundPixelScale)
+    renderBackground(pixelScale);
+
+  g.drawImage(background, getLocalBounds().toFloat());
+}
+
+void FuzzaAudioProcessorEditor::renderBackground(float pixelScale) {
+  backgroundPixelScale = pixelScale;
+
+  auto width = juce::jmax(1, juce::roundToInt(getWidth() * pixelScale));
+  auto height = juce::jmax(1, juce::roundToInt(getHeight() * pixelScale));
+  background = juce::Image(juce::Image::RGB, width, height, false);
+
+  juce::Graphics g(background);
+  g.addTransform(juce::AffineTransform::scale(
+      static_cast<float>(width) / designWidth,
+      static_cast<float>(height) / designHeight));
+  drawEnclosure(g);
+}
+
+void FuzzaAudioProcessorEditor::drawEnclosure(juce::Graphics &g) {
   // Pedal enclosure background (dark grey with gradient)
-  auto bounds = getLocalBounds();
+  auto bounds = juce::Rectangle<int>(designWidth, designHeight);
   juce::ColourGradient gradient(
       juce::Colour(0xff1a1a1a), bounds.getX(), bounds.getY(),
       juce::Colour(0xff2d2d2d), bounds.getX(), bounds.getBottom(),
@@ -149,8 +351,8 @@ void FuzzaAudioProcessorEditor::paint(juce::Graphics &g) {
                    juce::Justification::centred, 1);
 
   // Draw knob module boxes (3 boxes for visual grouping)
-  auto knobBoxBounds = getLocalBounds().reduced(25);
-  knobBoxBounds.removeFromTop(80 + 15 + 70 + 25 + 70 + 35); // Skip to knob area
+  auto knobBoxBounds = juce::Rectangle<int>(designWidth, designHeight).reduced(25);
+  knobBoxBounds.removeFromTop(80 + 15 + 100 + 10 + 70 + 20); // Skip to knob area
 
   int boxWidth = (knobBoxBounds.getWidth() - 40) / 3; // 3 boxes with spacing
   int boxHeight = 175; // Label + knob + value
@@ -183,13 +385,21 @@ void FuzzaAudioProcessorEditor::paint(juce::Graphics &g) {
   };
 
   drawScrew(15, 15);
-  drawScrew(getWidth() - 15, 15);
-  drawScrew(15, getHeight() - 15);
-  drawScrew(getWidth() - 15, getHeight() - 15);
+  drawScrew(designWidth - 15, 15);
+  drawScrew(15, designHeight - 15);
+  drawScrew(designWidth - 15, designHeight - 15);
 }
 
 void FuzzaAudioProcessorEditor::resized() {
-  auto bounds = getLocalBounds().reduced(25);
+  // New size: drop the cached enclosure and rescale the controls
+  background = {};
+
+  content.setBounds(0, 0, designWidth, designHeight);
+  content.setTransform(juce::AffineTransform::scale(
+      static_cast<float>(getWidth()) / designWidth,
+      static_cast<float>(getHeight()) / designHeight));
+
+  auto bounds = content.getLocalBounds().reduced(25);
 
   // Unified grid parameters
   int columnWidth = (bounds.getWidth() - 40) / 3; // 3 columns
@@ -199,8 +409,8 @@ void FuzzaAudioProcessorEditor::resized() {
   bounds.removeFromTop(80);
   bounds.removeFromTop(15); // Space after logo
 
-  // Tone preset buttons row - using unified grid
-  auto toneRow = bounds.removeFromTop(70);
+  // Tone preset buttons row - using unified grid, cutoff slider below
+  auto toneRow = bounds.removeFromTop(100);
   toneLabel.setBounds(toneRow.removeFromTop(25));
   auto toneButtons = toneRow.removeFromTop(40);
 
@@ -210,20 +420,34 @@ void FuzzaAudioProcessorEditor::resized() {
   toneButtons.removeFromLeft(columnSpacing);
   toneBrightButton.setBounds(toneButtons);
 
-  bounds.removeFromTop(25); // Space between button rows
+  toneRow.removeFromTop(5);
+  toneSlider.setBounds(toneRow.removeFromTop(30));
+
+  bounds.removeFromTop(10); // Space between button rows
 
-  // Clipping mode buttons row - using unified grid
+  // Clipping mode buttons row - four buttons, then the anti-aliasing
+  // selector at the right end of the row
   auto clipRow = bounds.removeFromTop(70);
+  int clipSpacing = 10;
+  int antialiasWidth = 100;
+  auto antialiasColumn = clipRow.removeFromRight(antialiasWidth);
+  clipRow.removeFromRight(clipSpacing);
+  antialiasLabel.setBounds(antialiasColumn.removeFromTop(25));
+  antialiasBox.setBounds(antialiasColumn.removeFromTop(40));
+
   clipLabel.setBounds(clipRow.removeFromTop(25));
   auto clipButtons = clipRow.removeFromTop(40);
+  int clipWidth = (clipButtons.getWidth() - 3 * clipSpacing) / 4;
 
-  clipHardButton.setBounds(clipButtons.removeFromLeft(columnWidth));
-  clipButtons.removeFromLeft(columnSpacing);
-  clipSoftButton.setBounds(clipButtons.removeFromLeft(columnWidth));
-  clipButtons.removeFromLeft(columnSpacing);
-  clipAsymButton.setBounds(clipButtons);
+  clipHardButton.setBounds(clipButtons.removeFromLeft(clipWidth));
+  clipButtons.removeFromLeft(clipSpacing);
+  clipSoftButton.setBounds(clipButtons.removeFromLeft(clipWidth));
+  clipButtons.removeFromLeft(clipSpacing);
+  clipAsymButton.setBounds(clipButtons.removeFromLeft(clipWidth));
+  clipButtons.removeFromLeft(clipSpacing);
+  clipMuffButton.setBounds(clipButtons);
 
-  bounds.removeFromTop(35); // More space before knobs
+  bounds.removeFromTop(20); // More space before knobs
 
   // Knob module boxes - using unified grid
   auto knobModuleArea = bounds.removeFromTop(175);
@@ -255,4 +479,21 @@ void FuzzaAudioProcessorEditor::resized() {
   // Bypass footswitch (bottom center with vertical centering)
   auto bypassArea = bounds.removeFromTop(70);
   bypassButton.setBounds(bypassArea.withSizeKeepingCentre(150, 48));
+
+  // Cabinet controls either side of the footswitch
+  cabinetButton.setBounds(
+      bypassArea.removeFromLeft(columnWidth).withSizeKeepingCentre(90, 32));
+  impulseResponseButton.setBounds(bypassArea.removeFromRight(columnWidth)
+                                      .withSizeKeepingCentre(columnWidth - 10, 32));
+
+  bounds.removeFromTop(15);
+
+  // Analyzer across the full width of the knob grid
+  analyzer.setBounds(bounds.removeFromTop(analyzerHeight));
+
+  // Meters in the side margins, clear of the screws
+  auto meterHeight = designHeight - 2 * meterTop;
+  inputMeter.setBounds(meterInset, meterTop, meterWidth, meterHeight);
+  outputMeter.setBounds(designWidth - meterInset - meterWidth, meterTop,
+                        meterWidth, meterHeight);
 }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "Analyzer.h"
+#include "LevelMeter.h"
 #include "PluginProcessor.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 
-class FuzzaAudioProcessorEditor : public juce::AudioProcessorEditor {
+class FuzzaAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                  private juce::Timer {
 public:
   FuzzaAudioProcessorEditor(FuzzaAudioProcessor &);
   ~FuzzaAudioProcessorEditor() override;
@@ -12,6 +15,21 @@ public:
   void resized() override;
 
 private:
+  // Drains the processor's telemetry, updates the meters and shows the
+  // analyzer's latest frame
+  void timerCallback() override;
+
+  // Static enclosure (gradient, border, logo, knob boxes, screws), drawn in
+  // design coordinates into a cached image at the display's pixel scale
+  void renderBackground(float pixelScale);
+  static void drawEnclosure(juce::Graphics &g);
+
+  juce::Image background;
+  float backgroundPixelScale = 0.0f;
+
+  // Holds every control at the design size, scaled to the editor size
+  juce::Component content;
+
   FuzzaAudioProcessor &audioProcessor;
 
   // Knobs (3x instead of 4)
@@ -27,18 +45,43 @@ private:
   // Bypass footswitch button (pedal style)
   juce::TextButton bypassButton;
 
-  // Tone preset buttons (3-way toggle)
+  // Tone preset buttons (3-way toggle) and the continuous cutoff under them
   juce::TextButton toneWarmButton;
   juce::TextButton toneBalancedButton;
   juce::TextButton toneBrightButton;
+  juce::Slider toneSlider;
   juce::Label toneLabel;
 
-  // Clipping mode buttons (3-way toggle)
+  // Clipping mode buttons (4-way toggle)
   juce::TextButton clipHardButton;
   juce::TextButton clipSoftButton;
   juce::TextButton clipAsymButton;
+  juce::TextButton clipMuffButton;
   juce::Label clipLabel;
 
+  // Clipper anti-aliasing (ANTIALIAS: Off / ADAA 1st / ADAA 2nd) beside them
+  juce::ComboBox antialiasBox;
+  juce::Label antialiasLabel;
+
+  // Cabinet on/off and IR file (either side of the footswitch)
+  juce::TextButton cabinetButton;
+  juce::TextButton impulseResponseButton;
+  std::unique_ptr<juce::FileChooser> impulseResponseChooser;
+
+  // Input (left edge) and output (right edge) meters. The output meter shows
+  // the output suppressor's gain reduction, the input meter the input gate's.
+  LevelMeter inputMeter;
+  LevelMeter outputMeter;
+
+  // Spectrum and transfer curve under the footswitch; runs (and makes the
+  // processor capture for it) only while the editor exists
+  Analyzer analyzer;
+
+  // Displayed meter values (with fall-off) and clip LED hold
+  float inputPeak = 0.0f, inputRms = 0.0f;
+  float outputPeak = 0.0f, outputRms = 0.0f;
+  int clipHoldFrames = 0;
+
   // Attachments
   std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
       bypassAttachment;
@@ -48,10 +91,17 @@ private:
       mixAttachment;
   std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
       gateAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
+      toneAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
+      cabinetAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>
+      antialiasAttachment;
 
   // Helper methods
-  void updateToneButtons(int selectedPreset);
-  void updateClipButtons(int selectedMode);
+  void updateToneButtons();
+  void updateClipButtons();
+  void updateImpulseResponseButton();
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FuzzaAudioProcessorEditor)
 };
@@ -1,5 +1,19 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeSanitizer.h"
+
+namespace {
+// Program change crossfade (at most one block)
+const double programCrossfadeSeconds = 0.01;
+
+// Input the incoming engine runs before a switch (or warms up on, for an
+// oversampling change), so its oversampler and delay lines are filled rather
+// than starting from silence
+const double programPrimingSeconds = 0.01;
+
+// How often the message thread checks whether the latency to report changed
+const int latencyPollRate = 20;
+} // namespace
 
 FuzzaAudioProcessor::FuzzaAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -9,9 +23,14 @@ FuzzaAudioProcessor::FuzzaAudioProcessor()
               .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
 #endif
       apvts(*this, nullptr, "Parameters", createParameterLayout()) {
+  for (size_t i = 0; i < parameterValues.size(); ++i)
+    parameterValues[i] =
+        apvts.getRawParameterValue(fuzza::BinaryState::parameterIds[i]);
+
+  startTimerHz(latencyPollRate);
 }
 
-FuzzaAudioProcessor::~FuzzaAudioProcessor() {}
+FuzzaAudioProcessor::~FuzzaAudioProcessor() { stopTimer(); }
 
 juce::AudioProcessorValueTreeState::ParameterLayout
 FuzzaAudioProcessor::createParameterLayout() {
@@ -24,10 +43,16 @@ FuzzaAudioProcessor::createParameterLayout() {
       juce::ParameterID{"GAIN", 1}, "Gain",
       juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f, 0.5f), 50.0f));
 
-  // Tone Preset: 0 = Warm (800Hz), 1 = Balanced (2000Hz), 2 = Bright (4500Hz)
-  layout.add(std::make_unique<juce::AudioParameterChoice>(
-      juce::ParameterID{"TONE_PRESET", 1}, "Tone Preset",
-      juce::StringArray{"Warm", "Balanced", "Bright"}, 1));
+  // Tone: low-pass cutoff in Hz, continuous and automatable. The WARM,
+  // BALANCED and BRIGHT buttons jump to 800 / 2000 / 4500 Hz.
+  juce::NormalisableRange<float> toneRange(
+      fuzza::FuzzEngineBase::minimumToneFrequency,
+      fuzza::FuzzEngineBase::maximumToneFrequency);
+  toneRange.setSkewForCentre(tonePresetFrequencies[1]);
+
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      juce::ParameterID{"TONE", 1}, "Tone", toneRange,
+      tonePresetFrequencies[1]));
 
   // Mix: Dry/Wet blend (0% = dry, 100% = wet)
   layout.add(std::make_unique<juce::AudioParameterFloat>(
@@ -39,10 +64,92 @@ FuzzaAudioProcessor::createParameterLayout() {
       juce::ParameterID{"GATE", 1}, "Gate",
       juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f));
 
-  // Clipping mode: 0 = Hard, 1 = Soft, 2 = Asymmetric
+  // Gate anti-chatter: hold time after the signal drops (ms) and how far
+  // below the opening threshold it must drop to close (dB). Off by default,
+  // so the gates sound as they always have.
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      juce::ParameterID{"GATE_HOLD", 1}, "Gate Hold",
+      juce::NormalisableRange<float>(0.0f, 200.0f, 1.0f), 0.0f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      juce::ParameterID{"GATE_HYSTERESIS", 1}, "Gate Hysteresis",
+      juce::NormalisableRange<float>(0.0f, 12.0f, 0.1f), 0.0f));
+
+  // Clipping mode: 0 = Hard, 1 = Soft, 2 = Asymmetric, 3 = Muff (diode
+  // clipper circuit model)
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       juce::ParameterID{"CLIP_MODE", 1}, "Clip Mode",
-      juce::StringArray{"Hard", "Soft", "Asymmetric"}, 0));
+      juce::StringArray{"Hard", "Soft", "Asymmetric", "Muff"}, 0));
+
+  // Antiderivative anti-aliasing for the clipper: 0 = Off, 1 = 1st order,
+  // 2 = 2nd order. No added latency; combines with oversampling.
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID{"ANTIALIAS", 1}, "Anti-Aliasing",
+      juce::StringArray{"Off", "ADAA 1st", "ADAA 2nd"}, 0));
+
+  // Oversampling for the clipping stage: 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID{"OVERSAMPLING", 1}, "Oversampling",
+      juce::StringArray{"1x", "2x", "4x", "8x"}, 0));
+
+  // Waveshaper precision for Soft/Asymmetric: 0 = Eco (Pade rational),
+  // 1 = Standard (lookup table), 2 = High (minimax rational)
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID{"PRECISION", 1}, "Precision",
+      juce::StringArray{"Eco", "Standard", "High"}, 2));
+
+  // Cabinet IR convolution after the tone filter; passes the signal through
+  // until an IR is loaded
+  layout.add(std::make_unique<juce::AudioParameterBool>(
+      juce::ParameterID{"CABINET", 1}, "Cabinet", false));
+
+  // Multiband clipping: Off = the single clipper above, otherwise 2-4 bands
+  // split at the crossovers, each with its own drive (dB on top of GAIN)
+  // and clip mode
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID{"BANDS", 1}, "Bands",
+      juce::StringArray{"Off", "2", "3", "4"}, 0));
+
+  const char *crossoverIds[] = {"CROSSOVER_LOW", "CROSSOVER_MID",
+                                "CROSSOVER_HIGH"};
+  const char *crossoverNames[] = {"Crossover Low", "Crossover Mid",
+                                  "Crossover High"};
+  const fuzza::FuzzEngineBase::Parameters defaults;
+
+  for (size_t i = 0; i < defaults.crossoverFrequencies.size(); ++i) {
+    juce::NormalisableRange<float> crossoverRange(
+        fuzza::FuzzEngineBase::crossoverLimits[i],
+        fuzza::FuzzEngineBase::crossoverLimits[i + 1], 1.0f);
+    crossoverRange.setSkewForCentre(defaults.crossoverFrequencies[i]);
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{crossoverIds[i], 1}, crossoverNames[i],
+        crossoverRange, defaults.crossoverFrequencies[i]));
+  }
+
+  for (int band = 1; band <= fuzza::FuzzEngineBase::maxBands; ++band)
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{"BAND" + juce::String(band) + "_GAIN", 1},
+        "Band " + juce::String(band) + " Gain",
+        juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f), 0.0f));
+
+  for (int band = 1; band <= fuzza::FuzzEngineBase::maxBands; ++band)
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID{"BAND" + juce::String(band) + "_CLIP", 1},
+        "Band " + juce::String(band) + " Clip",
+        juce::StringArray{"Hard", "Soft", "Asymmetric"}, 0));
+
+  // Quality: Manual = OVERSAMPLING and PRECISION as set, Adaptive = the best
+  // the CPU sustains in real time (always the best offline)
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID{"QUALITY", 1}, "Quality",
+      juce::StringArray{"Manual", "Adaptive"}, 0));
+
+  // Share of the block deadline one instance may use under Adaptive. The
+  // deadline is shared by every plugin in the session, so one instance
+  // measured against all of it would always find room for a better tier.
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      juce::ParameterID{"QUALITY_BUDGET", 1}, "Quality Budget",
+      juce::NormalisableRange<float>(1.0f, 100.0f, 1.0f), 10.0f));
 
   return layout;
 }
@@ -75,41 +182,338 @@ bool FuzzaAudioProcessor::isMidiEffect() const {
 #endif
 }
 
-double FuzzaAudioProcessor::getTailLengthSeconds() const { return 0.0; }
+double FuzzaAudioProcessor::getTailLengthSeconds() const {
+  // Output suppressor release (the engine sleeps on silence after this
+  // long), then the cabinet IR
+  return fuzza::FuzzEngineBase::getTailLengthSeconds() +
+         cabinet.getTailLengthSeconds();
+}
 
 int FuzzaAudioProcessor::getNumPrograms() {
-  return 1; // NB: some hosts don't cope very well if you tell them there are 0
-            // programs, so this should be at least 1, even if you're not really
-            // implementing programs.
+  return presetBank.getNumPrograms(); // Always at least the factory programs
 }
 
-int FuzzaAudioProcessor::getCurrentProgram() { return 0; }
+int FuzzaAudioProcessor::getCurrentProgram() { return currentProgram; }
 
-void FuzzaAudioProcessor::setCurrentProgram(int index) {}
+void FuzzaAudioProcessor::setCurrentProgram(int index) {
+  if (!juce::isPositiveAndBelow(index, presetBank.getNumPrograms()))
+    return;
+
+  currentProgram = index;
+  const auto &program = presetBank.getProgram(index);
+
+  // The audio thread switches from the snapshot in its next block and keeps
+  // using it until the parameters below are all written, so it never runs
+  // with half-updated parameters
+  programWritesInProgress.fetch_add(1, std::memory_order_acq_rel);
+  pendingProgram.store(&program, std::memory_order_release);
 
-const juce::String FuzzaAudioProcessor::getProgramName(int index) { return {}; }
+  // Then the parameters follow, for the host, the editor and later blocks
+  for (size_t i = 0; i < program.values.size(); ++i)
+    if (fuzza::PresetBank::isProgramParameter(i))
+      if (auto *parameter =
+              apvts.getParameter(fuzza::BinaryState::parameterIds[i]))
+        parameter->setValueNotifyingHost(
+            parameter->convertTo0to1(program.values[i]));
+
+  programWritesInProgress.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+const juce::String FuzzaAudioProcessor::getProgramName(int index) {
+  if (!juce::isPositiveAndBelow(index, presetBank.getNumPrograms()))
+    return {};
+
+  return presetBank.getProgram(index).name;
+}
 
 void FuzzaAudioProcessor::changeProgramName(int index,
-                                            const juce::String &newName) {}
+                                            const juce::String &newName) {
+  // The bank is read-only; rename user programs in their file
+  juce::ignoreUnused(index, newName);
+}
 
 void FuzzaAudioProcessor::prepareToPlay(double sampleRate,
                                         int samplesPerBlock) {
-  // Initialize tone filters (low-pass filters)
-  toneFilterLeft.reset();
-  toneFilterRight.reset();
+  // Allocates the engines' scratch, oversamplers and per-channel state for
+  // the current bus layout and resets all state. Only the engines for the
+  // host's processing precision are prepared.
+  const auto numChannels =
+      juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+  // A program change in the first block fades out from the current settings
+  const auto params = toEngineParameters(loadParameterValues());
+
+  if (isUsingDoublePrecision()) {
+    doubleEngines.prepare(sampleRate, samplesPerBlock, numChannels);
+    doubleEngines.lastParameters = params;
+  } else {
+    floatEngines.prepare(sampleRate, samplesPerBlock, numChannels);
+    floatEngines.lastParameters = params;
+  }
+
+  // Both engines of a set are prepared alike
+  for (size_t oversampling = 0; oversampling < oversamplingLatencies.size();
+       ++oversampling)
+    oversamplingLatencies[oversampling].store(
+        isUsingDoublePrecision()
+            ? doubleEngines.engines[0].getLatencySamples(
+                  static_cast<int>(oversampling))
+            : floatEngines.engines[0].getLatencySamples(
+                  static_cast<int>(oversampling)));
+
+  // Resamples the IR to the session rate
+  cabinet.prepare(sampleRate, numChannels);
+
+  telemetry.prepare(sampleRate);
+  analyzerTap.prepare(sampleRate, samplesPerBlock,
+                      isUsingDoublePrecision()
+                          ? doubleEngines.getMaximumLatencySamples()
+                          : floatEngines.getMaximumLatencySamples());
+  qualityGovernor.prepare(sampleRate);
+
+#if JUCE_DEBUG
+  const auto shared = fuzza::SharedResources::getStatistics();
+  DBG("Shared DSP resources: " << shared.numResources << " ("
+                               << static_cast<int>(shared.bytes) << " bytes), "
+                               << shared.numReferences << " holders, "
+                               << static_cast<int>(shared.bytesSaved)
+                               << " bytes saved");
+#endif
+
+  // Reported again even if unchanged, for hosts that reset it on prepare
+  reportedLatency.store(-1);
+  updateLatency(getReportedOversampling(loadParameterValues()));
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::EngineSet<SampleType>::prepare(double sampleRate,
+                                                         int samplesPerBlock,
+                                                         int numChannels) {
+  for (auto &engine : engines)
+    engine.prepare(sampleRate, samplesPerBlock, numChannels);
+
+  active = 0;
+  warmingOversampling = -1;
+
+  const auto crossfadeLength = juce::jlimit(
+      1, juce::jmax(1, samplesPerBlock),
+      juce::roundToInt(sampleRate * programCrossfadeSeconds));
+  crossfadeBuffer.setSize(numChannels, crossfadeLength);
+
+  const auto primingLength =
+      juce::jmax(1, juce::roundToInt(sampleRate * programPrimingSeconds));
+  primingBuffer.setSize(numChannels, primingLength);
+
+  // Long enough for the priming input or the largest latency the bypass
+  // path delays by, before the current block
+  inputHistory.setSize(numChannels,
+                       juce::jmax(primingLength, getMaximumLatencySamples()) +
+                           juce::jmax(1, samplesPerBlock));
+  inputHistory.clear();
+  historyPosition = 0;
+}
+
+template <typename SampleType>
+int FuzzaAudioProcessor::EngineSet<SampleType>::getMaximumLatencySamples()
+    const {
+  auto maximumLatency = 0;
+
+  for (int oversampling = 1;
+       oversampling < fuzza::FuzzEngineBase::numOversamplingFactors;
+       ++oversampling)
+    maximumLatency = juce::jmax(maximumLatency,
+                                engines[0].getLatencySamples(oversampling));
+
+  return maximumLatency;
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::EngineSet<SampleType>::pushInput(
+    const juce::AudioBuffer<SampleType> &buffer, int numChannels) {
+  numChannels = juce::jmin(numChannels, inputHistory.getNumChannels());
+  const auto historyLength = inputHistory.getNumSamples();
+
+  // A block longer than the history only leaves its end
+  const auto numSamples = juce::jmin(buffer.getNumSamples(), historyLength);
+  const auto start = buffer.getNumSamples() - numSamples;
+  const auto firstPart = juce::jmin(numSamples, historyLength - historyPosition);
+
+  for (int channel = 0; channel < numChannels; ++channel) {
+    inputHistory.copyFrom(channel, historyPosition, buffer, channel, start,
+                          firstPart);
+    inputHistory.copyFrom(channel, 0, buffer, channel, start + firstPart,
+                          numSamples - firstPart);
+  }
+
+  historyPosition = (historyPosition + numSamples) % historyLength;
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::EngineSet<SampleType>::readInput(
+    juce::AudioBuffer<SampleType> &destination, int numChannels,
+    int numSamples, int samplesBack) const {
+  // numSamples of the history, starting samplesBack before its end
+  const auto historyLength = inputHistory.getNumSamples();
+  const auto readPosition =
+      ((historyPosition - samplesBack) % historyLength + historyLength) %
+      historyLength;
+  const auto firstPart = juce::jmin(numSamples, historyLength - readPosition);
+
+  for (int channel = 0; channel < numChannels; ++channel) {
+    destination.copyFrom(channel, 0, inputHistory, channel, readPosition,
+                         firstPart);
+    destination.copyFrom(channel, firstPart, inputHistory, channel, 0,
+                         numSamples - firstPart);
+  }
+}
 
-  toneFilterLeft.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-  toneFilterRight.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
+template <typename SampleType>
+void FuzzaAudioProcessor::EngineSet<SampleType>::primeIncoming(
+    int numChannels, int numSamples,
+    const fuzza::FuzzEngineBase::Parameters &params) {
+  numChannels = juce::jmin(numChannels, primingBuffer.getNumChannels());
+  const auto historyLength = inputHistory.getNumSamples();
 
-  // Set filter type to low-pass
-  toneFilterLeft.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-  toneFilterRight.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+  // The input just before the current block, which is already in the history
+  const auto length =
+      juce::jmin(primingBuffer.getNumSamples(), historyLength - numSamples);
 
-  // Initialize gate gains
-  inputGateGainLeft = 0.0f;
-  inputGateGainRight = 0.0f;
-  outputGateGainLeft = 0.0f;
-  outputGateGainRight = 0.0f;
+  if (length <= 0)
+    return;
+
+  readInput(primingBuffer, numChannels, length, numSamples + length);
+
+  juce::AudioBuffer<SampleType> priming(primingBuffer.getArrayOfWritePointers(),
+                                        numChannels, length);
+  getIdle().process(priming, numChannels, params);
+}
+
+template <typename SampleType>
+bool FuzzaAudioProcessor::EngineSet<SampleType>::warmIdle(
+    const juce::AudioBuffer<SampleType> &buffer, int numChannels,
+    const fuzza::FuzzEngineBase::Parameters &params) {
+  auto &idle = getIdle();
+  const auto primingLength = primingBuffer.getNumSamples();
+
+  // A new factor (or another one than the idle engine was warming up at)
+  // starts over from the active engine's gates and tone filter
+  if (params.oversampling != warmingOversampling) {
+    idle.reset();
+    idle.continueFrom(getActive());
+    warmingOversampling = params.oversampling;
+    warmingSamples = primingLength;
+  }
+
+  if (warmingSamples <= 0)
+    return true;
+
+  // At most the end of the block, one priming length: whole blocks while
+  // they are shorter, so the warm-up input stays contiguous
+  numChannels = juce::jmin(numChannels, buffer.getNumChannels(),
+                           primingBuffer.getNumChannels());
+  const auto length = juce::jmin(buffer.getNumSamples(), primingLength);
+
+  for (int channel = 0; channel < numChannels; ++channel)
+    primingBuffer.copyFrom(channel, 0, buffer, channel,
+                           buffer.getNumSamples() - length, length);
+
+  juce::AudioBuffer<SampleType> warmUp(primingBuffer.getArrayOfWritePointers(),
+                                       numChannels, length);
+  idle.process(warmUp, numChannels, params);
+  warmingSamples -= length;
+  return false;
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::EngineSet<SampleType>::crossfadeToIdle(
+    juce::AudioBuffer<SampleType> &buffer, int numChannels,
+    const fuzza::FuzzEngineBase::Parameters &params) {
+  auto &outgoing = getActive();
+  auto &incoming = getIdle();
+
+  numChannels = juce::jmin(numChannels, buffer.getNumChannels(),
+                           crossfadeBuffer.getNumChannels());
+  const auto length =
+      juce::jmin(buffer.getNumSamples(), crossfadeBuffer.getNumSamples());
+
+  // The incoming engine takes over the outgoing engine's gate envelopes and
+  // tone filter, so it starts at the level the old sound is at rather than
+  // with closed gates
+  incoming.continueFrom(outgoing);
+
+  // The outgoing engine finishes the old sound over the crossfade only
+  for (int channel = 0; channel < numChannels; ++channel)
+    crossfadeBuffer.copyFrom(channel, 0, buffer, channel, 0, length);
+
+  juce::AudioBuffer<SampleType> fadeOut(
+      crossfadeBuffer.getArrayOfWritePointers(), numChannels, length);
+  outgoing.process(fadeOut, numChannels, lastParameters);
+
+  incoming.process(buffer, numChannels, params);
+
+  // Linear crossfade; both engines see the same input, so the two outputs
+  // are strongly correlated and equal gain keeps the level steady
+  for (int channel = 0; channel < numChannels; ++channel) {
+    auto *output = buffer.getWritePointer(channel);
+    const auto *old = fadeOut.getReadPointer(channel);
+
+    for (int sample = 0; sample < length; ++sample) {
+      const auto position =
+          static_cast<SampleType>(sample + 1) / static_cast<SampleType>(length);
+      output[sample] = old[sample] + position * (output[sample] - old[sample]);
+    }
+  }
+
+  active = 1 - active;
+  warmingOversampling = -1;
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::EngineSet<SampleType>::processBypassed(
+    juce::AudioBuffer<SampleType> &buffer, int numChannels,
+    int latencySamples) {
+  // The input, delayed by the latency the host compensates for, so that
+  // bypassing does not move the track against the others. Blocks longer than
+  // the history allows go through in parts.
+  numChannels = juce::jmin(numChannels, inputHistory.getNumChannels());
+  const auto historyLength = inputHistory.getNumSamples();
+  latencySamples = juce::jlimit(0, historyLength - 1, latencySamples);
+
+  for (int start = 0; start < buffer.getNumSamples();) {
+    const auto length = juce::jmin(buffer.getNumSamples() - start,
+                                   historyLength - latencySamples);
+    juce::AudioBuffer<SampleType> part(buffer.getArrayOfWritePointers(),
+                                       numChannels, start, length);
+    pushInput(part, numChannels);
+    readInput(part, numChannels, length, length + latencySamples);
+    start += length;
+  }
+}
+
+void FuzzaAudioProcessor::updateLatency(int oversampling) {
+  // Only the stored latencies, never the engines. Comparing the latency
+  // rather than the setting means a value a concurrent prepareToPlay()
+  // has since replaced is reported again on the next tick.
+  const auto latency =
+      oversamplingLatencies[static_cast<size_t>(juce::jlimit(
+                                0, fuzza::FuzzEngineBase::numOversamplingFactors - 1,
+                                oversampling))]
+          .load();
+
+  if (reportedLatency.exchange(latency) != latency)
+    setLatencySamples(latency);
+}
+
+void FuzzaAudioProcessor::timerCallback() {
+  updateLatency(getReportedOversampling(loadParameterValues()));
+}
+
+int FuzzaAudioProcessor::getReportedOversampling(
+    const ParameterValues &values) {
+  if (values[Index::quality] > 0.5f)
+    return fuzza::QualityGovernor::tiers.front().oversampling;
+
+  return static_cast<int>(values[Index::oversampling]);
 }
 
 void FuzzaAudioProcessor::releaseResources() {
@@ -124,12 +528,13 @@ bool FuzzaAudioProcessor::isBusesLayoutSupported(
   juce::ignoreUnused(layouts);
   return true;
 #else
-  // This is the place where you check if the layout is supported.
-  // In this template code we only support mono or stereo.
+  // Any layout from mono up to 7.1.4; every channel gets the same processing.
   // Some plugin hosts, such as certain GarageBand versions, will only
   // load plugins that support stereo bus layouts.
-  if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-      layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+  const auto &mainOutput = layouts.getMainOutputChannelSet();
+
+  if (mainOutput.isDisabled() ||
+      mainOutput.size() > fuzza::FuzzEngineBase::maxChannels)
     return false;
 
   // This checks if the input layout matches the output layout
@@ -143,9 +548,42 @@ bool FuzzaAudioProcessor::isBusesLayoutSupported(
 }
 #endif
 
+namespace {
+// Peak and RMS of the loudest channel
+template <typename SampleType>
+void measureLevels(const juce::AudioBuffer<SampleType> &buffer, int numChannels,
+                   float &peak, float &rms) {
+  peak = 0.0f;
+  rms = 0.0f;
+
+  for (int channel = 0; channel < numChannels; ++channel) {
+    peak = juce::jmax(peak, static_cast<float>(buffer.getMagnitude(
+                                channel, 0, buffer.getNumSamples())));
+    rms = juce::jmax(rms, static_cast<float>(buffer.getRMSLevel(
+                              channel, 0, buffer.getNumSamples())));
+  }
+}
+} // namespace
+
 void FuzzaAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                        juce::MidiBuffer &midiMessages) {
+  juce::ignoreUnused(midiMessages);
+  processSamples(buffer, floatEngines);
+}
+
+void FuzzaAudioProcessor::processBlock(juce::AudioBuffer<double> &buffer,
+                                       juce::MidiBuffer &midiMessages) {
+  juce::ignoreUnused(midiMessages);
+  processSamples(buffer, doubleEngines);
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::processSamples(
+    juce::AudioBuffer<SampleType> &buffer, EngineSet<SampleType> &engineSet) {
+  // Real-time sanitizer builds: no allocating, locking or blocking from here
+  const fuzza::RealtimeSanitizer::ScopedRealtime realtime;
   juce::ScopedNoDenormals noDenormals;
+  const auto startTicks = juce::Time::getHighResolutionTicks();
   auto totalNumInputChannels = getTotalNumInputChannels();
   auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -155,130 +593,203 @@ void FuzzaAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
     buffer.clear(i, 0, buffer.getNumSamples());
 
-  // Check bypass state
-  auto bypass = apvts.getRawParameterValue("BYPASS")->load() > 0.5f;
+  const auto numChannels =
+      juce::jmin(totalNumInputChannels, buffer.getNumChannels());
 
-  // If bypassed, skip all processing
-  if (bypass)
+  fuzza::BlockTelemetry telemetryBlock;
+  telemetryBlock.numSamples = buffer.getNumSamples();
+  measureLevels(buffer, numChannels, telemetryBlock.inputPeak,
+                telemetryBlock.inputRms);
+  analyzerTap.captureInput(buffer, numChannels, reportedLatency.load());
+
+  auto values = loadParameterValues();
+
+  // A program change takes the published snapshot (bypass and quality
+  // settings stay as they are) and holds it while the message thread is
+  // still writing the parameters; once it has finished they match it
+  auto *program = pendingProgram.exchange(nullptr, std::memory_order_acquire);
+
+  if (program != nullptr)
+    heldProgram = program;
+  else if (programWritesInProgress.load(std::memory_order_acquire) == 0)
+    heldProgram = nullptr;
+
+  if (heldProgram != nullptr)
+    for (size_t i = 0; i < values.size(); ++i)
+      if (fuzza::PresetBank::isProgramParameter(i))
+        values[i] = heldProgram->values[i];
+
+  // Check bypass state
+  auto bypass = values[Index::bypass] > 0.5f;
+
+  // If bypassed, skip all processing; the input still arrives with the
+  // reported latency
+  if (bypass) {
+    // A warm-up in progress starts over after the gap in its input
+    engineSet.warmingOversampling = -1;
+    engineSet.processBypassed(buffer, totalNumInputChannels,
+                              reportedLatency.load());
+    measureLevels(buffer, numChannels, telemetryBlock.outputPeak,
+                  telemetryBlock.outputRms);
+    analyzerTap.captureOutput(buffer, numChannels);
+    publishTelemetry(telemetryBlock, startTicks);
     return;
+  }
+
+  auto params = toEngineParameters(values);
+
+  // The oversampling filters delay the whole signal; the message thread
+  // keeps the host's delay compensation in sync when the factor changes.
+  // Until it has, and in adaptive quality for good, the engine pads its
+  // output up to the latency the host was told, so a manual OVERSAMPLING
+  // change does not move the track until the new latency is reported.
+  params.latencySamples = reportedLatency.load();
+
+  // Adaptive quality: the governor's tier. Offline renders always run at
+  // the top tier.
+  const auto adaptive = values[Index::quality] > 0.5f;
+
+  if (adaptive) {
+    if (isNonRealtime())
+      qualityGovernor.reset();
+
+    const auto &tier = isNonRealtime() ? fuzza::QualityGovernor::tiers.front()
+                                       : qualityGovernor.getTier();
+    params.oversampling = tier.oversampling;
+    params.precision = tier.precision;
+    telemetryBlock.qualityTier =
+        isNonRealtime() ? 0 : qualityGovernor.getTierIndex();
+  }
+
+  engineSet.pushInput(buffer, totalNumInputChannels);
+
+  // Fuzz Algorithm with Mix, Gate, and Multiple Clipping Modes. A new
+  // oversampling factor (manual or a quality tier) would restart the
+  // oversampler under the signal, so the idle engine warms up at it first,
+  // one block at a time next to the active one, and then takes over with a
+  // crossfade. No block runs the priming and both engines at once, least of
+  // all the one that made the governor step down. Precision and every other
+  // setting change in place.
+  if (program != nullptr) {
+    switchProgram(engineSet, buffer, totalNumInputChannels, params);
+  } else if (params.oversampling != engineSet.lastParameters.oversampling) {
+    if (engineSet.warmIdle(buffer, totalNumInputChannels, params)) {
+      engineSet.crossfadeToIdle(buffer, totalNumInputChannels, params);
+    } else {
+      // The active engine keeps its factor until then
+      params.oversampling = engineSet.lastParameters.oversampling;
+      engineSet.getActive().process(buffer, totalNumInputChannels, params);
+    }
+  } else {
+    // Back at the active engine's factor: any warm-up is dropped
+    engineSet.warmingOversampling = -1;
+    engineSet.getActive().process(buffer, totalNumInputChannels, params);
+  }
+
+  engineSet.lastParameters = params;
+
+  cabinet.process (buffer, numChannels, values[Index::cabinet] > 0.5f,
+                   !isNonRealtime());
+
+  auto &dspEngine = engineSet.getActive();
+  telemetryBlock.inputGateGain = dspEngine.getInputGateGain();
+  telemetryBlock.outputGateGain = dspEngine.getOutputGateGain();
+  telemetryBlock.clippedSamples = dspEngine.getNumClippedSamples();
+  measureLevels(buffer, numChannels, telemetryBlock.outputPeak,
+                telemetryBlock.outputRms);
+  analyzerTap.captureOutput(buffer, numChannels);
+
+  publishTelemetry(telemetryBlock, startTicks);
+
+  if (adaptive && !isNonRealtime()) {
+    qualityGovernor.setBudget(values[Index::qualityBudget] / 100.0);
+    qualityGovernor.update(telemetryBlock.processingSeconds,
+                           buffer.getNumSamples());
+  }
+}
+
+template <typename SampleType>
+void FuzzaAudioProcessor::switchProgram(
+    EngineSet<SampleType> &engineSet, juce::AudioBuffer<SampleType> &buffer,
+    int numChannels, const fuzza::FuzzEngineBase::Parameters &params) {
+  auto &outgoing = engineSet.getActive();
+  auto &incoming = engineSet.getIdle();
+
+  numChannels = juce::jmin(numChannels, buffer.getNumChannels(),
+                           engineSet.crossfadeBuffer.getNumChannels());
+
+  // Warm start: the incoming engine runs the last few milliseconds of input
+  // to fill its oversampler and delay lines, starting from the outgoing
+  // engine's gate envelopes and tone filter so the primed signal is at the
+  // level the old sound is at. A program has to take over at once, so this
+  // runs in the same block as the crossfade.
+  incoming.reset();
+  incoming.continueFrom(outgoing);
+  engineSet.primeIncoming(numChannels, buffer.getNumSamples(), params);
+  engineSet.crossfadeToIdle(buffer, numChannels, params);
+}
 
-  auto gainParam = apvts.getRawParameterValue("GAIN")->load();
-  auto tonePreset = static_cast<int>(apvts.getRawParameterValue("TONE_PRESET")->load());
-  auto mixParam = apvts.getRawParameterValue("MIX")->load() / 100.0f; // 0.0 ~ 1.0
-  auto gateParam = apvts.getRawParameterValue("GATE")->load() / 100.0f; // 0.0 ~ 1.0
-  auto clipMode = static_cast<int>(apvts.getRawParameterValue("CLIP_MODE")->load());
+FuzzaAudioProcessor::ParameterValues
+FuzzaAudioProcessor::loadParameterValues() const {
+  ParameterValues values{};
+
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = parameterValues[i]->load();
+
+  return values;
+}
+
+fuzza::FuzzEngineBase::Parameters
+FuzzaAudioProcessor::toEngineParameters(const ParameterValues &values) {
+  auto gainParam = values[Index::gain];
+  auto mixParam = values[Index::mix] / 100.0f;   // 0.0 ~ 1.0
+  auto gateParam = values[Index::gate] / 100.0f; // 0.0 ~ 1.0
+
+  fuzza::FuzzEngineBase::Parameters params;
 
   // Auto-compensation algorithm
-  float inputGain = juce::jmax(1.0f, gainParam);  // Minimum 1x (clean)
-  float makeupGain = 2.0f / std::sqrt(inputGain); // Sqrt-based compensation
+  params.inputGain = juce::jmax(1.0f, gainParam);         // Minimum 1x (clean)
+  params.makeupGain = 2.0f / std::sqrt(params.inputGain); // Sqrt-based compensation
 
   // Gate threshold (0.0 = no gate, 0.1 = aggressive)
-  float gateThreshold = gateParam * 0.1f;
-
-  // Tone preset mapping: Warm (800Hz), Balanced (2000Hz), Bright (4500Hz)
-  float toneFrequency = 2000.0f; // Default
-  switch (tonePreset) {
-    case 0: toneFrequency = 800.0f; break;   // Warm
-    case 1: toneFrequency = 2000.0f; break;  // Balanced
-    case 2: toneFrequency = 4500.0f; break;  // Bright
+  params.gateThreshold = gateParam * 0.1f;
+  params.gateHold = values[Index::gateHold] / 1000.0f;
+  params.gateHysteresis =
+      juce::Decibels::decibelsToGain(-values[Index::gateHysteresis]);
+
+  // Tone cutoff; the engine glides to it sample by sample
+  params.toneFrequency = values[Index::tone];
+
+  params.mix = mixParam;
+  params.clipMode = static_cast<int>(values[Index::clipMode]);
+  params.antialiasing = static_cast<fuzza::waveshaper::Antialiasing>(
+      static_cast<int>(values[Index::antialias]));
+  params.oversampling = static_cast<int>(values[Index::oversampling]);
+  params.precision = static_cast<fuzza::waveshaper::Precision>(
+      static_cast<int>(values[Index::precision]));
+
+  // Multiband: BANDS index 0 is Off (one band)
+  params.numBands = static_cast<int>(values[Index::bands]) + 1;
+  params.crossoverFrequencies = {values[Index::crossoverLow],
+                                 values[Index::crossoverMid],
+                                 values[Index::crossoverHigh]};
+
+  for (size_t band = 0; band < params.bandGains.size(); ++band) {
+    params.bandGains[band] =
+        juce::Decibels::decibelsToGain(values[Index::band1Gain + band]);
+    params.bandClipModes[band] =
+        static_cast<int>(values[Index::band1Clip + band]);
   }
 
-  // Update tone filter cutoff frequency
-  toneFilterLeft.setCutoffFrequency(toneFrequency);
-  toneFilterRight.setCutoffFrequency(toneFrequency);
-
-  // Fuzz Algorithm with Mix, Gate, and Multiple Clipping Modes
-  for (int channel = 0; channel < totalNumInputChannels; ++channel) {
-    auto *channelData = buffer.getWritePointer(channel);
-
-    // Gate Parameters
-    // Input Gate: Tight and Fast (removes noise before distortion)
-    const float inputAttack = 0.005f; // 5ms
-    const float inputRelease = 0.05f; // 50ms
-    const float alphaInputAttack = std::exp(-1.0f / (getSampleRate() * inputAttack));
-    const float alphaInputRelease = std::exp(-1.0f / (getSampleRate() * inputRelease));
-
-    // Output Suppressor: Smooth and Long (preserves sustain)
-    const float outputAttack = 0.02f;  // 20ms
-    const float outputRelease = 0.5f;  // 500ms
-    const float alphaOutputAttack = std::exp(-1.0f / (getSampleRate() * outputAttack));
-    const float alphaOutputRelease = std::exp(-1.0f / (getSampleRate() * outputRelease));
-
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-      float input = channelData[sample];
-
-      // --- Stage 1: Input Gate (Tight) ---
-      float inputAbs = std::abs(input);
-      float inputTargetGain = (inputAbs > gateThreshold) ? 1.0f : 0.0f;
-      
-      float& currentInputGateGain = (channel == 0) ? inputGateGainLeft : inputGateGainRight;
-      
-      if (inputTargetGain > currentInputGateGain) {
-          currentInputGateGain = (currentInputGateGain * alphaInputAttack) + (inputTargetGain * (1.0f - alphaInputAttack));
-      } else {
-          currentInputGateGain = (currentInputGateGain * alphaInputRelease) + (inputTargetGain * (1.0f - alphaInputRelease));
-      }
-
-      // Apply Input Gate
-      input *= currentInputGateGain;
-
-      float dry = input; 
-      float wet = dry;
-
-      // Apply input gain
-      wet *= inputGain;
-
-      // Clipping modes
-      switch (clipMode) {
-        case 0: // Hard clipping
-          wet = juce::jlimit(-1.0f, 1.0f, wet);
-          break;
-
-        case 1: // Soft clipping (tanh)
-          wet = std::tanh(wet);
-          break;
-
-        case 2: // Asymmetric clipping (vintage style)
-          if (wet > 0.0f)
-            wet = std::tanh(wet * 1.5f);
-          else
-            wet = juce::jlimit(-1.0f, 1.0f, wet);
-          break;
-      }
-
-      // Apply tone filter (low-pass)
-      if (channel == 0)
-        wet = toneFilterLeft.processSample(0, wet);
-      else if (channel == 1)
-        wet = toneFilterRight.processSample(0, wet);
-
-      // Apply automatic makeup gain
-      wet *= makeupGain;
-
-      // Mix dry and wet signals
-      float mixed = (dry * (1.0f - mixParam)) + (wet * mixParam);
-
-      // --- Stage 2: Output Suppressor (Smooth) ---
-      // Use a lower relative threshold for the output to allow tails to fade out naturally
-      // Since the signal might be boosted, we scale the threshold slightly or keep it same but rely on long release
-      float outputThreshold = gateThreshold * 0.5f; // Half threshold for output to keep tails
-      float outputAbs = std::abs(mixed);
-      float outputTargetGain = (outputAbs > outputThreshold) ? 1.0f : 0.0f;
-      
-      float& currentOutputGateGain = (channel == 0) ? outputGateGainLeft : outputGateGainRight;
-      
-      if (outputTargetGain > currentOutputGateGain) {
-          currentOutputGateGain = (currentOutputGateGain * alphaOutputAttack) + (outputTargetGain * (1.0f - alphaOutputAttack));
-      } else {
-          currentOutputGateGain = (currentOutputGateGain * alphaOutputRelease) + (outputTargetGain * (1.0f - alphaOutputRelease));
-      }
-
-      // Apply Output Suppressor
-      mixed *= currentOutputGateGain;
-
-      channelData[sample] = mixed;
-    }
-  }
+  return params;
+}
+
+void FuzzaAudioProcessor::publishTelemetry(fuzza::BlockTelemetry &block,
+                                           juce::int64 startTicks) {
+  block.processingSeconds =
+      static_cast<float>(juce::Time::highResolutionTicksToSeconds(
+          juce::Time::getHighResolutionTicks() - startTicks));
+  telemetry.publish(block);
 }
 
 bool FuzzaAudioProcessor::hasEditor() const {
@@ -290,24 +801,85 @@ juce::AudioProcessorEditor *FuzzaAudioProcessor::createEditor() {
 }
 
 void FuzzaAudioProcessor::getStateInformation(juce::MemoryBlock &destData) {
-  // You should use this method to store your parameters in the memory block.
-  // You could do that either as raw data, or use the XML or ValueTree classes
-  // as intermediaries
-  auto state = apvts.copyState();
-  std::unique_ptr<juce::XmlElement> xml(state.createXml());
-  copyXmlToBinary(*xml, destData);
+  // Straight from the parameters (no XML), plus the IR file
+  binaryState.write(destData, getImpulseResponseFile().getFullPathName());
 }
 
 void FuzzaAudioProcessor::setStateInformation(const void *data,
                                               int sizeInBytes) {
-  // You should use this method to restore your parameters from this memory
-  // block, whose contents will have been created by the getStateInformation()
-  // call.
+  juce::String impulseResponsePath;
+
+  if (binaryState.read(data, sizeInBytes, impulseResponsePath)) {
+    if (impulseResponsePath != getImpulseResponseFile().getFullPathName())
+      loadImpulseResponse(impulseResponsePath.isEmpty()
+                              ? juce::File()
+                              : juce::File(impulseResponsePath));
+    return;
+  }
+
+  // Sessions saved before the binary format hold APVTS XML
   std::unique_ptr<juce::XmlElement> xmlState(
       getXmlFromBinary(data, sizeInBytes));
   if (xmlState.get() != nullptr)
-    if (xmlState->hasTagName(apvts.state.getType()))
+    if (xmlState->hasTagName(apvts.state.getType())) {
+      migrateTonePreset(*xmlState);
       apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+    }
+}
+
+bool FuzzaAudioProcessor::loadImpulseResponse(const juce::File &file) {
+  juce::AudioBuffer<float> impulseResponse;
+  double impulseResponseRate = 0.0;
+
+  if (file != juce::File()) {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(
+        formats.createReaderFor(file));
+
+    if (reader == nullptr || reader->sampleRate <= 0.0 ||
+        reader->lengthInSamples <= 0)
+      return false;
+
+    // Mono or stereo; the convolver cuts the rest at its maximum length
+    const auto length = static_cast<int>(juce::jmin(
+        reader->lengthInSamples,
+        static_cast<juce::int64>(std::ceil(
+            reader->sampleRate * fuzza::CabinetConvolver::maxImpulseSeconds))));
+
+    impulseResponse.setSize(juce::jlimit(1, 2, static_cast<int>(reader->numChannels)),
+                            length);
+    reader->read(&impulseResponse, 0, length, 0, true, true);
+    impulseResponseRate = reader->sampleRate;
+  }
+
+  cabinet.setImpulseResponse(impulseResponse, impulseResponseRate);
+
+  const juce::ScopedLock lock(impulseResponseLock);
+  impulseResponseFile = file;
+  return true;
+}
+
+juce::File FuzzaAudioProcessor::getImpulseResponseFile() const {
+  const juce::ScopedLock lock(impulseResponseLock);
+  return impulseResponseFile;
+}
+
+void FuzzaAudioProcessor::migrateTonePreset(juce::XmlElement &state) {
+  // Sessions saved before TONE was continuous hold a TONE_PRESET index
+  if (state.getChildByAttribute("id", "TONE") != nullptr)
+    return;
+
+  if (auto *preset = state.getChildByAttribute("id", "TONE_PRESET")) {
+    auto index = juce::jlimit(0, 2, juce::roundToInt(
+                                        preset->getDoubleAttribute("value")));
+
+    auto *tone = state.createNewChildElement("PARAM");
+    tone->setAttribute("id", "TONE");
+    tone->setAttribute("value", tonePresetFrequencies[static_cast<size_t>(index)]);
+    state.removeChildElement(preset, true);
+  }
 }
 
 // This creates new instances of the plugin..
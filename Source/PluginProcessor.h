@@ -3,7 +3,16 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
-class FuzzaAudioProcessor  : public juce::AudioProcessor
+#include "BinaryState.h"
+#include "DSP/AnalyzerTap.h"
+#include "DSP/CabinetConvolver.h"
+#include "DSP/FuzzEngine.h"
+#include "PresetBank.h"
+#include "QualityGovernor.h"
+#include "DSP/Telemetry.h"
+
+class FuzzaAudioProcessor  : public juce::AudioProcessor,
+                             private juce::Timer
 {
 public:
     FuzzaAudioProcessor();
@@ -17,6 +26,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -39,21 +50,140 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
-private:
-    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    // Cabinet IR for the CABINET stage (any format the basic readers take,
+    // any rate). False, with the current IR kept, if the file cannot be
+    // read; a default File removes the IR.
+    bool loadImpulseResponse (const juce::File& file);
+    juce::File getImpulseResponseFile() const;
+
+    // TONE cutoffs (Hz) behind the WARM, BALANCED and BRIGHT buttons
+    static constexpr std::array<float, 3> tonePresetFrequencies { 800.0f, 2000.0f, 4500.0f };
 
-    // Tone filter (low-pass filter for each channel)
-    juce::dsp::StateVariableTPTFilter<float> toneFilterLeft;
-    juce::dsp::StateVariableTPTFilter<float> toneFilterRight;
+    // Per-block levels, gate gain reduction, clipping and CPU time, published
+    // wait-free from the audio thread (drained by the editor)
+    fuzza::Telemetry telemetry;
 
-    // Gate gain state for smoothing (Envelope Follower)
-    // Input Gate (Tight)
-    float inputGateGainLeft = 0.0f;
-    float inputGateGainRight = 0.0f;
+    // Decimated mono input/output pairs for the editor's analyzer, captured
+    // only while the analyzer is running
+    fuzza::AnalyzerTap analyzerTap;
+
+private:
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // Output Suppressor (Smooth/Sustain)
-    float outputGateGainLeft = 0.0f;
-    float outputGateGainRight = 0.0f;
+    using ParameterValues = fuzza::BinaryState::Values;
+    using Index = fuzza::BinaryState::Index;
+
+    // Cached parameter handles in BinaryState::parameterIds order (avoids
+    // string lookups on the audio thread)
+    std::array<std::atomic<float>*, fuzza::BinaryState::parameterIds.size()> parameterValues {};
+
+    ParameterValues loadParameterValues() const;
+    static fuzza::FuzzEngineBase::Parameters toEngineParameters (const ParameterValues& values);
+
+    // Session state: compact binary, reading the XML of older versions too
+    fuzza::BinaryState binaryState { apvts };
+
+    // Programs: immutable after construction. setCurrentProgram() publishes
+    // the chosen one here; the audio thread takes it and crossfades to it.
+    const fuzza::PresetBank presetBank { binaryState };
+    std::atomic<const fuzza::PresetBank::Program*> pendingProgram { nullptr };
+    int currentProgram = 0;
+
+    // Non-zero while setCurrentProgram() is still writing the parameters; the
+    // audio thread holds the snapshot (heldProgram) until it drops to zero
+    std::atomic<int> programWritesInProgress { 0 };
+    const fuzza::PresetBank::Program* heldProgram = nullptr;
+
+    // Maps the TONE_PRESET index of older saved states onto TONE
+    static void migrateTonePreset (juce::XmlElement& state);
+
+    // Latency (host-rate samples) of each OVERSAMPLING setting, stored by
+    // prepareToPlay() once the engines are built, so the timer never reads
+    // the engines while another prepareToPlay() rebuilds their oversamplers
+    std::array<std::atomic<int>, fuzza::FuzzEngineBase::numOversamplingFactors> oversamplingLatencies {};
+
+    // Latency last reported to the host, for the oversampling setting of
+    // getReportedOversampling(). In adaptive quality that is always the top
+    // tier's. Reported from prepareToPlay() and the message thread's timer,
+    // never from the audio thread, which pads every engine's output up to it
+    // (and delays the bypassed signal by it).
+    std::atomic<int> reportedLatency { 0 };
+    void updateLatency (int oversampling);
+    static int getReportedOversampling (const ParameterValues& values);
+
+    // Message thread: follows OVERSAMPLING and QUALITY changes
+    void timerCallback() override;
+
+    // QUALITY = Adaptive: oversampling and precision follow the measured
+    // block deadlines (audio thread only)
+    fuzza::QualityGovernor qualityGovernor;
+
+    // Block-based DSP cores (input gate, clipper, tone filter, output
+    // suppressor) for one processing precision. A program change runs the
+    // active engine with the old settings and the idle one, reset, with the
+    // new settings over the same block and crossfades between them; the idle
+    // engine then becomes the active one. An oversampling change does the
+    // same once the idle engine has warmed up at the new factor on the live
+    // input over the blocks before. Every other change, the quality tier's
+    // precision included, applies to the active engine in place.
+    template <typename SampleType>
+    struct EngineSet
+    {
+        std::array<fuzza::FuzzEngine<SampleType>, 2> engines;
+        int active = 0;
+
+        // Factor the idle engine is warming up at (-1 = none) and the input
+        // it still has to run before the crossfade
+        int warmingOversampling = -1;
+        int warmingSamples = 0;
+
+        // Input copy for the outgoing engine, one crossfade long
+        juce::AudioBuffer<SampleType> crossfadeBuffer;
+
+        // The most recent input (ring buffer, current block included), which
+        // primes the incoming engine's oversampler and delay lines on a
+        // program change and is the delayed dry signal while bypassed, and
+        // the scratch it is unrolled into (also the warm-up's input copy)
+        juce::AudioBuffer<SampleType> inputHistory, primingBuffer;
+        int historyPosition = 0;
+
+        // What the active engine ran with in the last block
+        fuzza::FuzzEngineBase::Parameters lastParameters;
+
+        fuzza::FuzzEngine<SampleType>& getActive() { return engines[static_cast<size_t> (active)]; }
+        fuzza::FuzzEngine<SampleType>& getIdle() { return engines[static_cast<size_t> (1 - active)]; }
+        void prepare (double sampleRate, int samplesPerBlock, int numChannels);
+        int getMaximumLatencySamples() const;
+        void pushInput (const juce::AudioBuffer<SampleType>& buffer, int numChannels);
+        void readInput (juce::AudioBuffer<SampleType>& destination, int numChannels, int numSamples, int samplesBack) const;
+        void primeIncoming (int numChannels, int numSamples, const fuzza::FuzzEngineBase::Parameters& params);
+        // Runs the idle engine at params.oversampling on a copy of the block;
+        // true (without running it) once it is warm
+        bool warmIdle (const juce::AudioBuffer<SampleType>& buffer, int numChannels, const fuzza::FuzzEngineBase::Parameters& params);
+        // Crossfades from the active engine (with lastParameters) to the idle
+        // one (with params) over the block, which then becomes the active one
+        void crossfadeToIdle (juce::AudioBuffer<SampleType>& buffer, int numChannels, const fuzza::FuzzEngineBase::Parameters& params);
+        void processBypassed (juce::AudioBuffer<SampleType>& buffer, int numChannels, int latencySamples);
+    };
+
+    // Shared body of both processBlock overloads
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, EngineSet<SampleType>& engineSet);
+
+    template <typename SampleType>
+    static void switchProgram (EngineSet<SampleType>& engineSet, juce::AudioBuffer<SampleType>& buffer,
+                               int numChannels, const fuzza::FuzzEngineBase::Parameters& params);
+
+    void publishTelemetry (fuzza::BlockTelemetry& block, juce::int64 startTicks);
+
+    // One engine set per processing precision, so each keeps its own state
+    EngineSet<float> floatEngines;
+    EngineSet<double> doubleEngines;
+
+    // Post-tone cabinet IR, shared by both precisions (it runs in float)
+    fuzza::CabinetConvolver cabinet;
+    juce::CriticalSection impulseResponseLock;
+    juce::File impulseResponseFile;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FuzzaAudioProcessor)
 };
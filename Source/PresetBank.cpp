@@ -0,0 +1,113 @@
+#include "PresetBank.h"
+
+#include <initializer_list>
+#include <utility>
+
+namespace fuzza {
+
+namespace {
+using Setting = std::pair<BinaryState::Index, float>;
+
+struct FactoryProgram {
+  const char *name;
+  std::initializer_list<Setting> settings;
+};
+
+// Settings that differ from the parameter defaults
+const FactoryProgram factoryPrograms[] = {
+    {"Init", {}},
+    {"Warm Fuzz",
+     {{BinaryState::gain, 40.0f},
+      {BinaryState::tone, 800.0f},
+      {BinaryState::clipMode, 1.0f}}},
+    {"Vintage Asymmetric",
+     {{BinaryState::gain, 70.0f},
+      {BinaryState::tone, 2000.0f},
+      {BinaryState::clipMode, 2.0f}}},
+    {"Bright Lead",
+     {{BinaryState::gain, 85.0f},
+      {BinaryState::tone, 4500.0f},
+      {BinaryState::gate, 15.0f}}},
+    {"Gated Stutter",
+     {{BinaryState::gain, 100.0f},
+      {BinaryState::gate, 60.0f},
+      {BinaryState::gateHold, 0.0f},
+      {BinaryState::gateHysteresis, 0.0f}}},
+    {"Parallel Blend",
+     {{BinaryState::gain, 60.0f},
+      {BinaryState::mix, 50.0f},
+      {BinaryState::clipMode, 1.0f}}},
+};
+} // namespace
+
+PresetBank::PresetBank(const BinaryState &parameters,
+                       const juce::File &userPresets) {
+  for (const auto &factory : factoryPrograms) {
+    Program program{factory.name, parameters.getDefaultValues()};
+
+    for (const auto &[index, value] : factory.settings)
+      program.values[index] = parameters.constrain(index, value);
+
+    programs.push_back(std::move(program));
+  }
+
+  loadUserPresets(parameters, userPresets);
+}
+
+juce::File PresetBank::getUserPresetFile() {
+  return juce::File::getSpecialLocation(
+             juce::File::userApplicationDataDirectory)
+      .getChildFile("Fuzza")
+      .getChildFile("Presets.json");
+}
+
+bool PresetBank::isProgramParameter(size_t index) {
+  switch (index) {
+  case BinaryState::bypass:
+  case BinaryState::antialias:
+  case BinaryState::oversampling:
+  case BinaryState::precision:
+  case BinaryState::cabinet:
+  case BinaryState::quality:
+  case BinaryState::qualityBudget:
+    return false;
+  default:
+    return index < BinaryState::parameterIds.size();
+  }
+}
+
+void PresetBank::loadUserPresets(const BinaryState &parameters,
+                                 const juce::File &file) {
+  if (!file.existsAsFile())
+    return;
+
+  auto parsed = juce::JSON::parse(file);
+  auto *entries = parsed.getArray();
+
+  if (entries == nullptr)
+    return;
+
+  for (const auto &entry : *entries) {
+    if (!entry.isObject())
+      continue;
+
+    Program program;
+    program.name = entry.getProperty("name", {}).toString();
+    program.values = parameters.getDefaultValues();
+
+    if (program.name.isEmpty())
+      program.name = "User " + juce::String(getNumPrograms() + 1);
+
+    for (size_t i = 0; i < program.values.size(); ++i) {
+      const juce::Identifier id(BinaryState::parameterIds[i]);
+
+      if (isProgramParameter(i) && entry.hasProperty(id))
+        program.values[i] = parameters.constrain(
+            i, static_cast<float>(static_cast<double>(entry[id])));
+    }
+
+    programs.push_back(std::move(program));
+  }
+}
+
+} // namespace fuzza
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "BinaryState.h"
+
+#include <juce_core/juce_core.h>
+
+#include <vector>
+
+namespace fuzza {
+
+// Program bank: the factory programs followed by the user's, read once from
+// a JSON file and never changed afterwards, so the audio thread can hold
+// pointers into it without locking.
+//
+// The user file is an array of objects with a "name" and any of the program
+// parameters by ID, in parameter units; missing parameters take their
+// defaults. Values are stored as the parameters will hold them:
+//
+//   [ { "name": "Octave Lead", "GAIN": 90, "TONE": 3500, "CLIP_MODE": 2 } ]
+class PresetBank {
+public:
+  using Values = BinaryState::Values;
+
+  struct Program {
+    juce::String name;
+    Values values{};
+  };
+
+  // Reads the user file if there is one; a missing or unreadable file leaves
+  // only the factory programs
+  explicit PresetBank(const BinaryState &parameters,
+                      const juce::File &userPresets = getUserPresetFile());
+
+  // <user application data>/Fuzza/Presets.json
+  static juce::File getUserPresetFile();
+
+  // Parameters a program sets. Bypass, the quality settings (ANTIALIAS,
+  // OVERSAMPLING, PRECISION, QUALITY, QUALITY_BUDGET) and the cabinet stay
+  // as the user has them.
+  static bool isProgramParameter(size_t index);
+
+  int getNumPrograms() const { return static_cast<int>(programs.size()); }
+  const Program &getProgram(int index) const {
+    return programs[static_cast<size_t>(index)];
+  }
+
+private:
+  void loadUserPresets(const BinaryState &parameters, const juce::File &file);
+
+  std::vector<Program> programs;
+};
+
+} // namespace fuzza
@@ -0,0 +1,105 @@
+#include "QualityGovernor.h"
+
+#include <cmath>
+
+namespace fuzza {
+
+namespace {
+// Step down after the smoothed load (of the budget) has stayed above
+// downLoad this long, or at once on a second block within missWindowSeconds
+// that took longer than the whole deadline on its own (a single miss is
+// more often the OS than the plugin)
+const double downLoad = 0.7;
+const double downHoldSeconds = 0.05;
+const double missWindowSeconds = 1.0;
+
+// Step up after the smoothed load has stayed below upLoad for the up hold
+const double upLoad = 0.35;
+const double minimumUpHoldSeconds = 2.0;
+const double maximumUpHoldSeconds = 60.0;
+
+// No further step until the last one has had time to show in the load (an
+// oversampling step runs two engines while the new one warms up and over
+// the crossfade)
+const double settleSeconds = 0.1;
+
+// Load smoothing
+const double attackSeconds = 0.02;
+const double releaseSeconds = 0.5;
+} // namespace
+
+void QualityGovernor::prepare(double newSampleRate) {
+  sampleRate = newSampleRate;
+  reset();
+}
+
+void QualityGovernor::setBudget(double fractionOfDeadline) {
+  budget = std::fmin(std::fmax(fractionOfDeadline, 0.01), 1.0);
+}
+
+void QualityGovernor::reset() {
+  tier = startTier;
+  time = 0.0;
+  smoothedLoad = 0.0;
+  overloadedSeconds = idleSeconds = 0.0;
+  lastChange = 0.0;
+  lastStepUp = lastMiss = -1.0e9;
+  upHoldSeconds = minimumUpHoldSeconds;
+}
+
+void QualityGovernor::update(double processingSeconds, int numSamples) {
+  if (numSamples <= 0 || sampleRate <= 0.0)
+    return;
+
+  const auto blockSeconds = numSamples / sampleRate;
+  const auto load = processingSeconds / (blockSeconds * budget);
+  time += blockSeconds;
+
+  const auto smoothing = load > smoothedLoad ? attackSeconds : releaseSeconds;
+  smoothedLoad += (load - smoothedLoad) *
+                  (1.0 - std::exp(-blockSeconds / smoothing));
+
+  overloadedSeconds = smoothedLoad > downLoad ? overloadedSeconds + blockSeconds
+                                              : 0.0;
+  idleSeconds = smoothedLoad < upLoad ? idleSeconds + blockSeconds : 0.0;
+
+  // A long stable stretch forgives earlier failed steps up
+  if (time - lastChange > maximumUpHoldSeconds)
+    upHoldSeconds = minimumUpHoldSeconds;
+
+  auto repeatedMiss = false;
+
+  if (processingSeconds > blockSeconds) {
+    repeatedMiss = time - lastMiss < missWindowSeconds;
+    lastMiss = time;
+  }
+
+  if (time - lastChange < settleSeconds)
+    return;
+
+  if (repeatedMiss || overloadedSeconds > downHoldSeconds)
+    step(1);
+  else if (idleSeconds > upHoldSeconds)
+    step(-1);
+}
+
+void QualityGovernor::step(int direction) {
+  const auto next = tier + direction;
+
+  if (next < 0 || next >= static_cast<int>(tiers.size()))
+    return;
+
+  if (direction > 0) {
+    // The last step up did not hold: wait longer before the next one
+    if (time - lastStepUp < upHoldSeconds)
+      upHoldSeconds = std::fmin(upHoldSeconds * 2.0, maximumUpHoldSeconds);
+  } else {
+    lastStepUp = time;
+  }
+
+  tier = next;
+  lastChange = time;
+  overloadedSeconds = idleSeconds = 0.0;
+}
+
+} // namespace fuzza
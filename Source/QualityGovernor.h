@@ -0,0 +1,82 @@
+#pragma once
+
+#include "DSP/Waveshapers.h"
+
+#include <array>
+
+namespace fuzza {
+
+// Adaptive quality for QUALITY = Adaptive: picks the oversampling factor and
+// waveshaper precision from the block deadlines the processor measures.
+//
+// Each block reports how long processing took. The load is that time over
+// this instance's budget: a fraction of the block duration (block size /
+// sample rate), since the host has to fit every plugin in the session into
+// the same deadline. The load is smoothed (fast attack, slow release);
+// staying above downLoad for a moment, or missing two deadlines in quick
+// succession, steps one tier down, and staying below upLoad for the up hold
+// steps one tier up. The thresholds are far enough apart that the next tier
+// up, at roughly twice the cost, still fits. A step up that has to be taken
+// back within the hold doubles the hold, so a machine on the edge of a tier
+// settles below it instead of alternating.
+//
+// Audio thread only, no allocation or locking.
+class QualityGovernor {
+public:
+  struct Tier {
+    int oversampling; // OVERSAMPLING index
+    waveshaper::Precision precision;
+  };
+
+  // Best first. A precision step applies to the running engine at once; an
+  // oversampling step warms the other engine up over the next blocks and
+  // then crossfades (see FuzzaAudioProcessor::EngineSet).
+  //
+  // There is no gate detection rate axis. The gates already decide once per
+  // 0.25 ms segment, and what they cost per sample is the count and the gain
+  // ramp, not the decision: doubling the segment saved nothing measurable
+  // at 1x Eco, and counting every other sample under 1 ns of about 17 ns per
+  // sample (both within run-to-run noise), while moving the gate edges.
+  static constexpr std::array<Tier, 7> tiers{{
+      {3, waveshaper::Precision::high},
+      {2, waveshaper::Precision::high},
+      {1, waveshaper::Precision::high},
+      {1, waveshaper::Precision::standard},
+      {0, waveshaper::Precision::high},
+      {0, waveshaper::Precision::standard},
+      {0, waveshaper::Precision::eco},
+  }};
+
+  // Where a session starts: 1x High, the default manual settings
+  static constexpr int startTier = 4;
+
+  void prepare(double sampleRate);
+
+  // Fraction of each block's duration this instance may spend (clamped to
+  // 0.01 ... 1)
+  void setBudget(double fractionOfDeadline);
+
+  // Back to the start tier with no load history
+  void reset();
+
+  const Tier &getTier() const { return tiers[static_cast<size_t>(tier)]; }
+  int getTierIndex() const { return tier; }
+
+  // Measured processing time of a block of numSamples
+  void update(double processingSeconds, int numSamples);
+
+private:
+  void step(int direction);
+
+  double sampleRate = 44100.0;
+  double budget = 0.1;
+  int tier = startTier;
+
+  double time = 0.0; // Seconds of audio processed
+  double smoothedLoad = 0.0;
+  double overloadedSeconds = 0.0, idleSeconds = 0.0;
+  double lastChange = 0.0, lastStepUp = -1.0e9, lastMiss = -1.0e9;
+  double upHoldSeconds = 0.0;
+};
+
+} // namespace fuzza
@@ -0,0 +1,443 @@
+// The interceptors below define libc functions; with fortification on, glibc
+// defines some of them (open, read) inline in its headers
+#undef _FORTIFY_SOURCE
+
+#include "RealtimeSanitizer.h"
+
+#if FUZZA_REALTIME_SANITIZER
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+// glibc's allocator under its public names, so the interceptors can reach it
+// without dlsym (which allocates)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+}
+
+// Exception specification the glibc headers declare these functions with
+#define FUZZA_LIBC_NOTHROW __THROW
+#elif defined(__APPLE__)
+#define FUZZA_LIBC_NOTHROW
+#else
+#error "FUZZA_REALTIME_SANITIZER supports glibc (Linux) and macOS only"
+#endif
+
+namespace fuzza {
+
+namespace {
+// Deepest stack reported per call site
+const int maxFrames = 48;
+
+// Call sites remembered so each is reported once (more are counted, not
+// reported)
+const int numSiteSlots = 1024;
+
+std::atomic<int64_t> numViolations{0};
+std::atomic<uintptr_t> reportedSites[numSiteSlots];
+
+// Per-thread nesting depths. pthread keys rather than thread_local: the
+// first access to thread_local storage on a thread may allocate (macOS, and
+// modules loaded with dlopen), which would re-enter malloc below.
+pthread_key_t realtimeKey, uncheckedKey;
+pthread_once_t keysOnce = PTHREAD_ONCE_INIT;
+std::atomic<bool> keysReady{false};
+
+void createKeys() {
+  pthread_key_create(&realtimeKey, nullptr);
+  pthread_key_create(&uncheckedKey, nullptr);
+  keysReady.store(true, std::memory_order_release);
+}
+
+intptr_t getDepth(pthread_key_t key) {
+  return reinterpret_cast<intptr_t>(pthread_getspecific(key));
+}
+
+void addDepth(pthread_key_t key, intptr_t change) {
+  pthread_setspecific(key, reinterpret_cast<void *>(getDepth(key) + change));
+}
+
+// The sanitizer's own work on a thread (reporting, looking up the system's
+// functions) goes unchecked
+struct ScopedUnchecked {
+  ScopedUnchecked() : active(keysReady.load(std::memory_order_acquire)) {
+    if (active)
+      addDepth(uncheckedKey, 1);
+  }
+
+  ~ScopedUnchecked() {
+    if (active)
+      addDepth(uncheckedKey, -1);
+  }
+
+  const bool active;
+};
+
+// True the first time a stack hash is seen (false once the table is full)
+bool isNewSite(uintptr_t site) {
+  site = site == 0 ? 1 : site;
+
+  for (int probe = 0; probe < numSiteSlots; ++probe) {
+    auto &slot = reportedSites[(site + static_cast<uintptr_t>(probe)) %
+                               numSiteSlots];
+    auto expected = uintptr_t(0);
+
+    if (slot.compare_exchange_strong(expected, site) || expected == site)
+      return expected == 0;
+  }
+
+  return false;
+}
+
+void writeText(const char *text) {
+  [[maybe_unused]] const auto written =
+      ::write(STDERR_FILENO, text, std::strlen(text));
+}
+
+// A checked function was called inside processBlock. Not inlined, so the
+// stack starts at the interceptor that called it; a debugger breakpoint here
+// stops at every violation.
+__attribute__((noinline)) void reportViolation(const char *function) {
+  numViolations.fetch_add(1, std::memory_order_relaxed);
+  const ScopedUnchecked unchecked;
+
+  void *frames[maxFrames];
+  const auto numFrames = backtrace(frames, maxFrames);
+
+  // FNV-1a over the return addresses: the same call site reached the same
+  // way is reported once, however many blocks repeat it
+  uint64_t hash = 14695981039346656037ull;
+
+  for (int i = 1; i < numFrames; ++i) {
+    hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(frames[i]));
+    hash *= 1099511628211ull;
+  }
+
+  if (!isNewSite(static_cast<uintptr_t>(hash)))
+    return;
+
+  writeText("FuzzaRealtimeSanitizer: ");
+  writeText(function);
+  writeText(" called inside processBlock\n");
+  backtrace_symbols_fd(frames + 1, numFrames - 1, STDERR_FILENO);
+  writeText("\n");
+}
+
+inline void check(const char *function) {
+  if (keysReady.load(std::memory_order_acquire) &&
+      getDepth(realtimeKey) > 0 && getDepth(uncheckedKey) == 0)
+    reportViolation(function);
+}
+
+// The next definition of an intercepted function (the system's), looked up
+// on first use
+template <typename Function> class Next {
+public:
+  explicit constexpr Next(const char *nameToUse) : name(nameToUse) {}
+
+  Function *get() {
+    auto *function = address.load(std::memory_order_acquire);
+
+    if (function == nullptr) {
+      const ScopedUnchecked unchecked;
+      function = dlsym(RTLD_NEXT, name);
+      address.store(function, std::memory_order_release);
+    }
+
+    return reinterpret_cast<Function *>(function);
+  }
+
+private:
+  const char *name;
+  std::atomic<void *> address{nullptr};
+};
+
+#if defined(__GLIBC__)
+void *realMalloc(size_t size) { return __libc_malloc(size); }
+void *realCalloc(size_t count, size_t size) {
+  return __libc_calloc(count, size);
+}
+void *realRealloc(void *pointer, size_t size) {
+  return __libc_realloc(pointer, size);
+}
+void realFree(void *pointer) { __libc_free(pointer); }
+#else
+Next<void *(size_t)> nextMalloc{"malloc"};
+Next<void *(size_t, size_t)> nextCalloc{"calloc"};
+Next<void *(void *, size_t)> nextRealloc{"realloc"};
+Next<void(void *)> nextFree{"free"};
+
+void *realMalloc(size_t size) { return nextMalloc.get()(size); }
+void *realCalloc(size_t count, size_t size) {
+  return nextCalloc.get()(count, size);
+}
+void *realRealloc(void *pointer, size_t size) {
+  return nextRealloc.get()(pointer, size);
+}
+void realFree(void *pointer) { nextFree.get()(pointer); }
+#endif
+
+Next<int(pthread_mutex_t *)> nextMutexLock{"pthread_mutex_lock"};
+Next<int(pthread_rwlock_t *)> nextReadLock{"pthread_rwlock_rdlock"};
+Next<int(pthread_rwlock_t *)> nextWriteLock{"pthread_rwlock_wrlock"};
+Next<unsigned int(unsigned int)> nextSleep{"sleep"};
+Next<int(useconds_t)> nextMicrosecondSleep{"usleep"};
+Next<int(const timespec *, timespec *)> nextNanosecondSleep{"nanosleep"};
+Next<int(const char *, int, ...)> nextOpen{"open"};
+Next<FILE *(const char *, const char *)> nextFileOpen{"fopen"};
+Next<ssize_t(int, void *, size_t)> nextRead{"read"};
+Next<ssize_t(int, const void *, size_t)> nextWrite{"write"};
+
+// operator new/delete go to the system allocator directly, so each call is
+// reported as itself rather than again as malloc/free
+void *allocate(size_t size, const char *function) {
+  check(function);
+  return realMalloc(size == 0 ? 1 : size);
+}
+
+void *allocateAligned(size_t size, std::align_val_t alignment,
+                      const char *function) {
+  check(function);
+  void *pointer = nullptr;
+
+  if (posix_memalign(&pointer,
+                     std::max(static_cast<size_t>(alignment), sizeof(void *)),
+                     size == 0 ? 1 : size) != 0)
+    return nullptr;
+
+  return pointer;
+}
+
+void release(void *pointer, const char *function) {
+  if (pointer == nullptr)
+    return;
+
+  check(function);
+  realFree(pointer);
+}
+} // namespace
+
+RealtimeSanitizer::ScopedRealtime::ScopedRealtime() {
+  pthread_once(&keysOnce, createKeys);
+  addDepth(realtimeKey, 1);
+}
+
+RealtimeSanitizer::ScopedRealtime::~ScopedRealtime() {
+  addDepth(realtimeKey, -1);
+}
+
+int64_t RealtimeSanitizer::getNumViolations() {
+  return numViolations.load(std::memory_order_relaxed);
+}
+
+} // namespace fuzza
+
+// Interceptors. Defined in the executable (or plugin), these take the place
+// of the system's functions for every caller that links against them.
+extern "C" {
+
+void *malloc(size_t size) FUZZA_LIBC_NOTHROW {
+  fuzza::check("malloc");
+  return fuzza::realMalloc(size);
+}
+
+void *calloc(size_t count, size_t size) FUZZA_LIBC_NOTHROW {
+  fuzza::check("calloc");
+  return fuzza::realCalloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) FUZZA_LIBC_NOTHROW {
+  fuzza::check("realloc");
+  return fuzza::realRealloc(pointer, size);
+}
+
+void free(void *pointer) FUZZA_LIBC_NOTHROW {
+  if (pointer != nullptr)
+    fuzza::check("free");
+
+  fuzza::realFree(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) FUZZA_LIBC_NOTHROW {
+  fuzza::check("pthread_mutex_lock");
+  return fuzza::nextMutexLock.get()(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *lock) FUZZA_LIBC_NOTHROW {
+  fuzza::check("pthread_rwlock_rdlock");
+  return fuzza::nextReadLock.get()(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *lock) FUZZA_LIBC_NOTHROW {
+  fuzza::check("pthread_rwlock_wrlock");
+  return fuzza::nextWriteLock.get()(lock);
+}
+
+unsigned int sleep(unsigned int seconds) {
+  fuzza::check("sleep");
+  return fuzza::nextSleep.get()(seconds);
+}
+
+int usleep(useconds_t microseconds) {
+  fuzza::check("usleep");
+  return fuzza::nextMicrosecondSleep.get()(microseconds);
+}
+
+int nanosleep(const timespec *duration, timespec *remaining) {
+  fuzza::check("nanosleep");
+  return fuzza::nextNanosecondSleep.get()(duration, remaining);
+}
+
+int open(const char *path, int flags, ...) {
+  fuzza::check("open");
+
+  // The mode argument only exists when a file may be created
+  int mode = 0;
+  auto createsFile = (flags & O_CREAT) != 0;
+#ifdef O_TMPFILE
+  createsFile = createsFile || (flags & O_TMPFILE) == O_TMPFILE;
+#endif
+
+  if (createsFile) {
+    va_list arguments;
+    va_start(arguments, flags);
+    mode = va_arg(arguments, int);
+    va_end(arguments);
+  }
+
+  return fuzza::nextOpen.get()(path, flags, mode);
+}
+
+FILE *fopen(const char *path, const char *mode) {
+  fuzza::check("fopen");
+  return fuzza::nextFileOpen.get()(path, mode);
+}
+
+ssize_t read(int file, void *buffer, size_t size) {
+  fuzza::check("read");
+  return fuzza::nextRead.get()(file, buffer, size);
+}
+
+ssize_t write(int file, const void *buffer, size_t size) {
+  fuzza::check("write");
+  return fuzza::nextWrite.get()(file, buffer, size);
+}
+
+} // extern "C"
+
+void *operator new(std::size_t size) {
+  if (auto *pointer = fuzza::allocate(size, "operator new"))
+    return pointer;
+
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+  if (auto *pointer = fuzza::allocate(size, "operator new[]"))
+    return pointer;
+
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return fuzza::allocate(size, "operator new");
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return fuzza::allocate(size, "operator new[]");
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  if (auto *pointer = fuzza::allocateAligned(size, alignment, "operator new"))
+    return pointer;
+
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  if (auto *pointer =
+          fuzza::allocateAligned(size, alignment, "operator new[]"))
+    return pointer;
+
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  return fuzza::allocateAligned(size, alignment, "operator new");
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  return fuzza::allocateAligned(size, alignment, "operator new[]");
+}
+
+void operator delete(void *pointer) noexcept {
+  fuzza::release(pointer, "operator delete");
+}
+
+void operator delete[](void *pointer) noexcept {
+  fuzza::release(pointer, "operator delete[]");
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+  fuzza::release(pointer, "operator delete");
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+  fuzza::release(pointer, "operator delete[]");
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  fuzza::release(pointer, "operator delete");
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  fuzza::release(pointer, "operator delete[]");
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  fuzza::release(pointer, "operator delete");
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+  fuzza::release(pointer, "operator delete[]");
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+  fuzza::release(pointer, "operator delete");
+}
+
+void operator delete[](void *pointer, std::size_t,
+                       std::align_val_t) noexcept {
+  fuzza::release(pointer, "operator delete[]");
+}
+
+void operator delete(void *pointer, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  fuzza::release(pointer, "operator delete");
+}
+
+void operator delete[](void *pointer, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  fuzza::release(pointer, "operator delete[]");
+}
+
+#endif
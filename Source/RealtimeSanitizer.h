@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+// Set by the FUZZA_REALTIME_SANITIZER CMake option
+#ifndef FUZZA_REALTIME_SANITIZER
+#define FUZZA_REALTIME_SANITIZER 0
+#endif
+
+namespace fuzza {
+
+// Real-time safety checker for the audio thread. In a
+// FUZZA_REALTIME_SANITIZER build, a thread inside a ScopedRealtime
+// (processBlock) must not call
+//
+//   operator new/delete, malloc, calloc, realloc, free
+//   pthread_mutex_lock, pthread_rwlock_rdlock/wrlock (every std::mutex,
+//   juce::CriticalSection and condition variable wait goes through these)
+//   sleep, usleep, nanosleep, open, fopen, read, write
+//
+// Each call site that does is reported once on stderr with its stack, and
+// every call is counted; the console tools fail when the count is not zero.
+// Other threads, and the audio thread outside processBlock, are not checked.
+//
+// Linux (glibc) and macOS only. On macOS, malloc and the system calls are
+// only seen when called from the executable's own code (Fuzza and JUCE,
+// linked statically), not from inside system libraries; operator new/delete
+// are seen everywhere.
+//
+// In other builds ScopedRealtime is empty and nothing is intercepted. Not
+// for plugin builds that ship: the interceptors replace the allocator entry
+// points of the whole process.
+class RealtimeSanitizer {
+public:
+  // Marks the calling thread as real-time while it exists (nestable)
+  class ScopedRealtime {
+  public:
+#if FUZZA_REALTIME_SANITIZER
+    ScopedRealtime();
+    ~ScopedRealtime();
+#else
+    ScopedRealtime() {}
+    ~ScopedRealtime() {}
+#endif
+
+    ScopedRealtime(const ScopedRealtime &) = delete;
+    ScopedRealtime &operator=(const ScopedRealtime &) = delete;
+  };
+
+  static constexpr bool isEnabled() { return FUZZA_REALTIME_SANITIZER != 0; }
+
+  // Calls made inside a ScopedRealtime so far, on any thread
+#if FUZZA_REALTIME_SANITIZER
+  static int64_t getNumViolations();
+#else
+  static int64_t getNumViolations() { return 0; }
+#endif
+};
+
+} // namespace fuzza
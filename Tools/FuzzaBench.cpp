@@ -0,0 +1,225 @@
+// FuzzaBench: headless micro-benchmark for FuzzaAudioProcessor::processBlock.
+//
+// Instantiates the processor without an editor or audio device and drives it
+// with a synthetic guitar-like signal across every clip mode, tone preset,
+// gate on/off, block sizes 16..4096 and sample rates 44.1..192 kHz. Results
+// are written as JSON (ns/sample and instances-per-core per configuration).
+//
+// With --bands the clipper runs in multiband mode (1..3 = 2..4 bands), every
+// band on the clip mode of the case, so the cost can be compared with the
+// single-band runs directly (the Muff circuit is single-band, so its
+// multiband runs use Asymmetric bands).
+//
+// In a FUZZA_REALTIME_SANITIZER build the timings are inflated by the checks
+// (the report says so); the sweep then serves as a real-time safety check
+// and exits with 1 if processBlock allocated, locked or blocked in any case.
+//
+// Usage: FuzzaBench [--seconds=N] [--oversampling=0..3] [--antialias=0..2]
+//                   [--bands=0..3] [--output=file.json]
+
+#include "ToolUtilities.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+const double sampleRates[] = {44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0};
+const int blockSizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+const char *clipModeNames[] = {"Hard", "Soft", "Asymmetric", "Muff"};
+const char *tonePresetNames[] = {"Warm", "Balanced", "Bright"};
+
+// Gate setting used for the "gate on" runs (0-100 %)
+const float gateOnValue = 30.0f;
+
+using fuzza::tools::setParameter;
+
+// One second of plucked notes with a noise floor and a silent gap, so the
+// gates open, release and close during every run
+juce::AudioBuffer<float> makeTestSignal(double sampleRate) {
+  const auto numSamples = static_cast<int>(sampleRate);
+  juce::AudioBuffer<float> signal(2, numSamples);
+  juce::Random random(0x46757a7a);
+
+  const float noteFrequencies[] = {82.41f, 110.0f, 146.83f, 196.0f};
+  const auto noteLength = numSamples / 5;
+
+  for (int channel = 0; channel < signal.getNumChannels(); ++channel) {
+    auto *data = signal.getWritePointer(channel);
+
+    for (int sample = 0; sample < numSamples; ++sample) {
+      auto note = sample / noteLength;
+
+      if (note >= 4) { // Silent gap
+        data[sample] = 0.0f;
+        continue;
+      }
+
+      auto t = static_cast<float>((sample % noteLength) / sampleRate);
+      auto phase = juce::MathConstants<float>::twoPi * noteFrequencies[note] * t;
+      auto envelope = 0.5f * std::exp(-4.0f * t);
+      auto noise = 0.002f * (random.nextFloat() * 2.0f - 1.0f);
+
+      data[sample] = envelope * std::sin(phase + 0.3f * channel) + noise;
+    }
+  }
+
+  return signal;
+}
+
+struct Result {
+  double nanosecondsPerSample = 0.0;
+  double instancesPerCore = 0.0;
+};
+
+Result runCase(FuzzaAudioProcessor &processor,
+               const juce::AudioBuffer<float> &signal, double sampleRate,
+               int blockSize, double seconds) {
+  processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+  processor.prepareToPlay(sampleRate, blockSize);
+
+  juce::AudioBuffer<float> block(2, blockSize);
+  juce::MidiBuffer midi;
+
+  const auto signalLength = signal.getNumSamples();
+  int readPosition = 0;
+
+  auto fillBlock = [&] {
+    for (int sample = 0; sample < blockSize;) {
+      auto count = juce::jmin(blockSize - sample, signalLength - readPosition);
+
+      for (int channel = 0; channel < 2; ++channel)
+        block.copyFrom(channel, sample, signal, channel, readPosition, count);
+
+      sample += count;
+      readPosition = (readPosition + count) % signalLength;
+    }
+  };
+
+  // Warm up caches, branch predictors and the gate envelopes
+  for (int i = 0; i < 16; ++i) {
+    fillBlock();
+    processor.processBlock(block, midi);
+  }
+
+  const auto totalSamples = static_cast<juce::int64>(seconds * sampleRate);
+  juce::int64 processedSamples = 0;
+  std::chrono::nanoseconds elapsed{0};
+
+  // Only processBlock itself is timed, not the input copy
+  while (processedSamples < totalSamples) {
+    fillBlock();
+
+    auto start = std::chrono::steady_clock::now();
+    processor.processBlock(block, midi);
+    elapsed += std::chrono::steady_clock::now() - start;
+
+    processedSamples += blockSize;
+  }
+
+  processor.releaseResources();
+
+  Result result;
+  result.nanosecondsPerSample =
+      static_cast<double>(elapsed.count()) / static_cast<double>(processedSamples);
+
+  // How many instances one core could run in real time at this buffer size
+  auto nanosecondsPerBlock = result.nanosecondsPerSample * blockSize;
+  auto deadlineNanoseconds = 1.0e9 * blockSize / sampleRate;
+  result.instancesPerCore = deadlineNanoseconds / nanosecondsPerBlock;
+
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  auto seconds = args.containsOption("--seconds")
+                     ? args.getValueForOption("--seconds").getDoubleValue()
+                     : 1.0;
+  auto oversampling = args.containsOption("--oversampling")
+                          ? args.getValueForOption("--oversampling").getIntValue()
+                          : 0;
+  auto antialiasing = args.containsOption("--antialias")
+                          ? args.getValueForOption("--antialias").getIntValue()
+                          : 0;
+  auto bands = args.containsOption("--bands")
+                   ? args.getValueForOption("--bands").getIntValue()
+                   : 0;
+  auto outputPath = args.getValueForOption("--output");
+
+  FuzzaAudioProcessor processor;
+  setParameter(processor, "GAIN", 100.0f);
+  setParameter(processor, "MIX", 100.0f);
+  setParameter(processor, "OVERSAMPLING", static_cast<float>(oversampling));
+  setParameter(processor, "ANTIALIAS", static_cast<float>(antialiasing));
+  setParameter(processor, "BANDS", static_cast<float>(bands));
+
+  juce::Array<juce::var> results;
+
+  for (auto sampleRate : sampleRates) {
+    auto signal = makeTestSignal(sampleRate);
+
+    for (auto blockSize : blockSizes)
+      for (int clipMode = 0; clipMode < 4; ++clipMode)
+        for (int tonePreset = 0; tonePreset < 3; ++tonePreset)
+          for (auto gateOn : {false, true}) {
+            setParameter(processor, "CLIP_MODE", static_cast<float>(clipMode));
+
+            // Bands have the curves only; the Muff circuit is single-band
+            for (int band = 1; band <= 4; ++band)
+              setParameter(processor, "BAND" + juce::String(band) + "_CLIP",
+                           static_cast<float>(juce::jmin(clipMode, 2)));
+
+            setParameter(processor, "TONE",
+                         FuzzaAudioProcessor::tonePresetFrequencies[static_cast<size_t>(tonePreset)]);
+            setParameter(processor, "GATE", gateOn ? gateOnValue : 0.0f);
+
+            auto result = runCase(processor, signal, sampleRate, blockSize, seconds);
+
+            auto *entry = new juce::DynamicObject();
+            entry->setProperty("sampleRate", sampleRate);
+            entry->setProperty("blockSize", blockSize);
+            entry->setProperty("clipMode", clipModeNames[clipMode]);
+            entry->setProperty("tonePreset", tonePresetNames[tonePreset]);
+            entry->setProperty("gate", gateOn);
+            entry->setProperty("nsPerSample", result.nanosecondsPerSample);
+            entry->setProperty("instancesPerCore", result.instancesPerCore);
+            results.add(juce::var(entry));
+
+            std::cerr << sampleRate << " Hz, " << blockSize << " samples, "
+                      << clipModeNames[clipMode] << ", "
+                      << tonePresetNames[tonePreset]
+                      << (gateOn ? ", gate on: " : ", gate off: ")
+                      << result.nanosecondsPerSample << " ns/sample, "
+                      << result.instancesPerCore << " instances/core\n";
+          }
+  }
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("version", JucePlugin_VersionString);
+  report->setProperty("secondsPerCase", seconds);
+  report->setProperty("oversampling", oversampling);
+  report->setProperty("antialiasing", antialiasing);
+  report->setProperty("bands", bands);
+  report->setProperty("realtimeSanitizer",
+                      fuzza::RealtimeSanitizer::isEnabled());
+  report->setProperty("results", results);
+
+  auto json = juce::JSON::toString(juce::var(report));
+
+  if (outputPath.isEmpty()) {
+    std::cout << json << std::endl;
+  } else if (!juce::File::getCurrentWorkingDirectory()
+                  .getChildFile(outputPath)
+                  .replaceWithText(json)) {
+    std::cerr << "Could not write " << outputPath << std::endl;
+    return 1;
+  }
+
+  return fuzza::tools::checkRealtimeSafety() ? 0 : 1;
+}
@@ -0,0 +1,742 @@
+// FuzzaNullTest: null-test regression check of FuzzaAudioProcessor against
+// the frozen scalar reference in ReferenceFuzz.h.
+//
+// Every case runs the same seeded random signal (plucked notes, noise,
+// silent gaps, full-scale bursts) through processBlock and through the
+// reference, with random block sizes and random GAIN/MIX automation applied
+// identically to both. The difference must stay within a max-abs and an RMS
+// budget for the waveshaper precision in use. Cases cover every reference
+// CLIP_MODE x TONE preset x PRECISION at several sample rates, the 64-bit
+// path and mono to 7.1.4 buses.
+//
+// The gates decide at control rate (every 0.25ms) where the reference
+// decides every sample, so a gate opening or closing can land up to one
+// segment apart. Cases that automate GATE as well are held to their own,
+// looser budget; every other reference case keeps GATE at 0.
+//
+// Oversampled, anti-aliased (ADAA), multiband and Muff output has no scalar
+// reference; it is covered by golden hashes only. A hash of every case's
+// output (quantised to 16 bits) is compared with the golden file, so
+// unintended changes from optimisations or compiler upgrades show up even
+// where they are inside the budgets. With --golden, a case missing from the
+// file fails too. Record the file (Tools/NullTestGolden.json, target
+// FuzzaNullTestGolden) with --update-golden after an intentional change.
+//
+// A second set of cases checks that the output level stays continuous when
+// the engine is switched mid-note (OVERSAMPLING change, program reload) with
+// the gates on: the crossfade must not dip while a restarted engine's gates
+// open again.
+//
+// Exits with 1 if any budget, hash or continuity check fails, or, in a
+// FUZZA_REALTIME_SANITIZER build, if processBlock allocated, locked or
+// blocked in any case.
+//
+// Usage: FuzzaNullTest [--golden=NullTestGolden.json] [--update-golden]
+//                      [--filter=text] [--verbose]
+
+#include "ReferenceFuzz.h"
+#include "ToolUtilities.h"
+
+#include <functional>
+#include <iostream>
+#include <map>
+
+namespace {
+
+using fuzza::tools::ReferenceFuzz;
+using fuzza::tools::setParameter;
+
+const double signalSeconds = 2.0;
+const int maximumBlockSize = 512;
+
+const char *clipModeNames[] = {"Hard", "Soft", "Asymmetric", "Muff"};
+const char *tonePresetNames[] = {"Warm", "Balanced", "Bright"};
+const char *precisionNames[] = {"Eco", "Standard", "High"};
+
+// Allowed difference from the reference per PRECISION tier. The clipper
+// error (1e-4 / 6e-6 / 4e-7) is scaled by up to 2x makeup gain. About 10x
+// the worst case measured when the budgets were set; every run prints the
+// worst case per budget, so they can be checked again.
+struct Budget {
+  double maxAbs;
+  double rms;
+};
+
+const Budget budgets[] = {{1.0e-3, 5.0e-5}, {1.0e-4, 1.0e-5},
+                          {1.0e-5, 1.0e-6}};
+
+// The 64-bit path is closer to exact than the float reference itself
+const Budget doublePrecisionBudget = {1.0e-4, 1.0e-5};
+
+// With GATE automated: a gate edge up to one control-rate segment early or
+// late, on a block of attack or release. Measured worst 1.4e-2 max abs and
+// 6.1e-5 RMS (GATE held at 30%, 48kHz, 64-bit); the peak is a single
+// segment, so the RMS budget is the one that catches a drifting envelope.
+const Budget gateBudget = {5.0e-2, 5.0e-4};
+
+struct TestCase {
+  juce::String name;
+  double sampleRate = 48000.0;
+  int numChannels = 2;
+  int clipMode = 0;
+  int tonePreset = 1;
+  int precision = 2;
+  int oversampling = 0;
+  int antialiasing = 0; // ANTIALIAS index
+  int bands = 0;        // BANDS index (0 = single band)
+  bool mixedBandClips = false; // band N clips in mode (clipMode + N - 1) % 3
+  bool doublePrecision = false;
+  bool gate = true; // GATE automated along with GAIN and MIX; else held at 0
+
+  // Only the single-band, host-rate, reference clip modes have a scalar
+  // reference; everything else is checked by its hash alone
+  bool hasReference() const {
+    return clipMode < fuzza::FuzzEngineBase::muffClip && oversampling == 0 &&
+           antialiasing == 0 && bands == 0;
+  }
+};
+
+struct CaseResult {
+  bool supported = true;
+  double maxAbs = 0.0;
+  double rms = 0.0;
+  juce::String hash;
+};
+
+std::vector<TestCase> makeTestCases() {
+  std::vector<TestCase> cases;
+
+  auto add = [&cases](TestCase test) {
+    test.name = juce::String(juce::roundToInt(test.sampleRate)) + "/" +
+                juce::String(test.numChannels) + "ch/" +
+                clipModeNames[test.clipMode] + "/" +
+                tonePresetNames[test.tonePreset] + "/" +
+                precisionNames[test.precision] + "/" +
+                juce::String(1 << test.oversampling) + "x/" +
+                (test.doublePrecision ? "double" : "float");
+
+    if (test.antialiasing > 0)
+      test.name << "/ADAA" << test.antialiasing;
+
+    if (test.bands > 0)
+      test.name << "/" << (test.bands + 1) << "band";
+
+    if (test.mixedBandClips)
+      test.name << "/mixed";
+
+    if (!test.gate)
+      test.name << "/ungated";
+
+    cases.push_back(test);
+  };
+
+  // Every reference mode, preset and precision at common session rates
+  for (auto sampleRate : {44100.0, 48000.0, 96000.0})
+    for (int clipMode = 0; clipMode < fuzza::FuzzEngineBase::muffClip;
+         ++clipMode)
+      for (int tonePreset = 0; tonePreset < 3; ++tonePreset)
+        for (int precision = 0; precision < 3; ++precision) {
+          TestCase test;
+          test.sampleRate = sampleRate;
+          test.clipMode = clipMode;
+          test.tonePreset = tonePreset;
+          test.precision = precision;
+          test.gate = false;
+          add(test);
+        }
+
+  // The control-rate gates against the per-sample reference gates
+  for (auto sampleRate : {44100.0, 48000.0, 96000.0})
+    for (int clipMode = 0; clipMode < fuzza::FuzzEngineBase::muffClip;
+         ++clipMode) {
+      TestCase gateTest;
+      gateTest.sampleRate = sampleRate;
+      gateTest.clipMode = clipMode;
+      add(gateTest);
+    }
+
+  for (int clipMode = 0; clipMode < fuzza::FuzzEngineBase::numClipModes;
+       ++clipMode) {
+    // 64-bit processing, with and without the gates
+    for (auto gate : {false, true}) {
+      TestCase doubleTest;
+      doubleTest.clipMode = clipMode;
+      doubleTest.doublePrecision = true;
+      doubleTest.gate = gate;
+      add(doubleTest);
+    }
+
+    // Mono, 5.1 and 7.1.4 buses
+    for (auto numChannels : {1, 6, 12}) {
+      TestCase busTest;
+      busTest.clipMode = clipMode;
+      busTest.numChannels = numChannels;
+      busTest.gate = false;
+      add(busTest);
+    }
+
+    // Oversampled clipper (golden hash only)
+    for (int oversampling = 1; oversampling < 4; ++oversampling) {
+      TestCase oversampledTest;
+      oversampledTest.clipMode = clipMode;
+      oversampledTest.oversampling = oversampling;
+      add(oversampledTest);
+    }
+
+    // Anti-aliased clipper, alone and with oversampling (golden hash only)
+    for (int antialiasing = 1; antialiasing < 3; ++antialiasing)
+      for (int oversampling : {0, 1}) {
+        TestCase antialiasedTest;
+        antialiasedTest.clipMode = clipMode;
+        antialiasedTest.antialiasing = antialiasing;
+        antialiasedTest.oversampling = oversampling;
+        add(antialiasedTest);
+      }
+  }
+
+  // Multiband (golden hash only): 2, 3 and 4 bands, every band in one clip
+  // mode and then each band in a different one (Hard/Soft/Asymmetric/Hard)
+  for (int bands = 1; bands <= 3; ++bands) {
+    for (int clipMode = 0; clipMode < fuzza::FuzzEngineBase::muffClip;
+         ++clipMode) {
+      TestCase bandTest;
+      bandTest.clipMode = clipMode;
+      bandTest.bands = bands;
+      add(bandTest);
+    }
+
+    TestCase mixedTest;
+    mixedTest.bands = bands;
+    mixedTest.mixedBandClips = true;
+    add(mixedTest);
+  }
+
+  // Muff circuit (golden hash only): every diode table precision at every
+  // oversampling rate. High precision above 1x is already covered by the
+  // oversampled cases.
+  for (int precision = 0; precision < 3; ++precision)
+    for (int oversampling = 0; oversampling < 4; ++oversampling) {
+      if (precision == 2 && oversampling > 0)
+        continue;
+
+      TestCase muffTest;
+      muffTest.clipMode = fuzza::FuzzEngineBase::muffClip;
+      muffTest.precision = precision;
+      muffTest.oversampling = oversampling;
+      add(muffTest);
+    }
+
+  return cases;
+}
+
+// Guitar-like material that drives every stage: decaying notes at random
+// pitches and levels, hiss, silent gaps long enough for the gates to close
+// (and the engine to sleep), and full-scale bursts
+juce::AudioBuffer<float> makeTestSignal(double sampleRate, int numChannels,
+                                        juce::Random &random) {
+  const auto numSamples = static_cast<int>(signalSeconds * sampleRate);
+  juce::AudioBuffer<float> signal(numChannels, numSamples);
+  signal.clear();
+
+  for (int start = 0; start < numSamples;) {
+    const auto length = static_cast<int>(sampleRate *
+                                         (0.05 + 0.3 * random.nextDouble()));
+    const auto end = juce::jmin(numSamples, start + length);
+    const auto kind = random.nextInt(6);
+
+    const auto frequency = 60.0f + 900.0f * random.nextFloat();
+    const auto level = kind == 5 ? 1.0f : 0.8f * random.nextFloat();
+    const auto noiseLevel = 0.01f * random.nextFloat();
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+      auto *data = signal.getWritePointer(channel);
+
+      if (kind == 0) // Silent gap
+        continue;
+
+      for (int sample = start; sample < end; ++sample) {
+        auto t = static_cast<float>((sample - start) / sampleRate);
+        auto phase = juce::MathConstants<float>::twoPi * frequency * t;
+        auto envelope = level * std::exp(-6.0f * t);
+        auto noise = noiseLevel * (random.nextFloat() * 2.0f - 1.0f);
+
+        data[sample] = envelope * std::sin(phase + 0.7f * channel) + noise;
+      }
+    }
+
+    start = end;
+  }
+
+  return signal;
+}
+
+// Random host automation of the continuous parameters between blocks. GATE
+// draws its values either way, so every case hears the same GAIN and MIX.
+void automate(FuzzaAudioProcessor &processor, juce::Random &random,
+              bool gate) {
+  if (random.nextInt(4) == 0)
+    setParameter(processor, "GAIN", 100.0f * random.nextFloat());
+
+  if (random.nextInt(6) == 0)
+    setParameter(processor, "MIX",
+                 random.nextBool() ? 100.0f : 100.0f * random.nextFloat());
+
+  if (random.nextInt(6) == 0) {
+    auto value = random.nextBool() ? 0.0f : 100.0f * random.nextFloat();
+
+    if (gate)
+      setParameter(processor, "GATE", value);
+  }
+}
+
+// The values processBlock will read, after the parameters' own snapping
+ReferenceFuzz::Settings readSettings(FuzzaAudioProcessor &processor) {
+  auto value = [&processor](const char *id) {
+    return processor.apvts.getRawParameterValue(id)->load();
+  };
+
+  ReferenceFuzz::Settings settings;
+  settings.gain = value("GAIN");
+  settings.toneFrequency = value("TONE");
+  settings.mix = value("MIX");
+  settings.gate = value("GATE");
+  settings.clipMode = static_cast<int>(value("CLIP_MODE"));
+  return settings;
+}
+
+// 64-bit FNV-1a over the output quantised to 16 bits
+struct OutputHash {
+  juce::uint64 value = 0xcbf29ce484222325ull;
+
+  void add(float sample) {
+    auto quantised = static_cast<juce::int16>(
+        juce::roundToInt(juce::jlimit(-1.0f, 1.0f, sample) * 32767.0f));
+
+    auto bits = static_cast<juce::uint16>(quantised);
+
+    for (auto byte : {bits & 0xff, bits >> 8}) {
+      value ^= static_cast<juce::uint64>(byte);
+      value *= 0x100000001b3ull;
+    }
+  }
+
+  juce::String toString() const {
+    return juce::String::toHexString(static_cast<juce::int64>(value))
+        .paddedLeft('0', 16);
+  }
+};
+
+CaseResult runCase(const TestCase &test) {
+  CaseResult result;
+  FuzzaAudioProcessor processor;
+
+  if (test.doublePrecision)
+    processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+  processor.setPlayConfigDetails(test.numChannels, test.numChannels,
+                                 test.sampleRate, maximumBlockSize);
+
+  if (processor.getTotalNumInputChannels() != test.numChannels) {
+    result.supported = false;
+    return result;
+  }
+
+  setParameter(processor, "CLIP_MODE", static_cast<float>(test.clipMode));
+  setParameter(processor, "TONE",
+               FuzzaAudioProcessor::tonePresetFrequencies[static_cast<size_t>(
+                   test.tonePreset)]);
+  setParameter(processor, "PRECISION", static_cast<float>(test.precision));
+  setParameter(processor, "OVERSAMPLING", static_cast<float>(test.oversampling));
+  setParameter(processor, "ANTIALIAS", static_cast<float>(test.antialiasing));
+  setParameter(processor, "BANDS", static_cast<float>(test.bands));
+
+  // Multiband takes its clip mode per band
+  for (int band = 1; band <= fuzza::FuzzEngineBase::maxBands; ++band)
+    setParameter(processor, "BAND" + juce::String(band) + "_CLIP",
+                 static_cast<float>(
+                     test.mixedBandClips
+                         ? (test.clipMode + band - 1) %
+                               fuzza::FuzzEngineBase::muffClip
+                         : test.clipMode));
+
+  setParameter(processor, "GAIN", 50.0f);
+  setParameter(processor, "MIX", 100.0f);
+  setParameter(processor, "GATE", 0.0f);
+
+  processor.prepareToPlay(test.sampleRate, maximumBlockSize);
+
+  ReferenceFuzz reference;
+  reference.prepare(test.sampleRate, maximumBlockSize, test.numChannels);
+
+  // Same seed for every case, so all cases hear the same material
+  juce::Random random(0x4e756c6c);
+  const auto signal = makeTestSignal(test.sampleRate, test.numChannels, random);
+
+  juce::AudioBuffer<float> production(test.numChannels, maximumBlockSize);
+  juce::AudioBuffer<double> productionDouble(test.numChannels,
+                                             maximumBlockSize);
+  juce::AudioBuffer<float> expected(test.numChannels, maximumBlockSize);
+  juce::MidiBuffer midi;
+
+  OutputHash hash;
+  double sumOfSquares = 0.0;
+  juce::int64 numCompared = 0;
+
+  for (int start = 0; start < signal.getNumSamples();) {
+    // Hosts rarely deliver the announced block size every time
+    auto blockSize = random.nextBool() ? maximumBlockSize
+                                       : 1 + random.nextInt(maximumBlockSize);
+    blockSize = juce::jmin(blockSize, signal.getNumSamples() - start);
+
+    automate(processor, random, test.gate);
+
+    production.setSize(test.numChannels, blockSize, false, false, true);
+    expected.setSize(test.numChannels, blockSize, false, false, true);
+
+    for (int channel = 0; channel < test.numChannels; ++channel) {
+      production.copyFrom(channel, 0, signal, channel, start, blockSize);
+      expected.copyFrom(channel, 0, signal, channel, start, blockSize);
+    }
+
+    if (test.doublePrecision) {
+      productionDouble.makeCopyOf(production, true);
+      processor.processBlock(productionDouble, midi);
+      production.makeCopyOf(productionDouble, true);
+    } else {
+      processor.processBlock(production, midi);
+    }
+
+    reference.process(expected, readSettings(processor));
+
+    for (int channel = 0; channel < test.numChannels; ++channel) {
+      auto *actual = production.getReadPointer(channel);
+      auto *wanted = expected.getReadPointer(channel);
+
+      for (int sample = 0; sample < blockSize; ++sample) {
+        hash.add(actual[sample]);
+
+        auto difference = static_cast<double>(actual[sample]) - wanted[sample];
+        result.maxAbs = juce::jmax(result.maxAbs, std::abs(difference));
+        sumOfSquares += difference * difference;
+      }
+    }
+
+    numCompared += static_cast<juce::int64>(blockSize) * test.numChannels;
+    start += blockSize;
+  }
+
+  result.rms = std::sqrt(sumOfSquares / static_cast<double>(numCompared));
+  result.hash = hash.toString();
+  return result;
+}
+
+// Engine switches mid-note. A steady 250 Hz note (an integer period at
+// 48 kHz, so a one-period RMS window has no ripple) runs with the gates on;
+// after the switch, the level of every window must stay within the budget of
+// the level before it. A restarted engine dips by well over 10 dB while its
+// gates reopen; two settings of the same sound differ by a fraction of a dB.
+struct SwitchCase {
+  juce::String name;
+  int oversampling = 0;
+  std::function<void(FuzzaAudioProcessor &)> change;
+};
+
+const double switchSampleRate = 48000.0;
+const int switchBlockSize = 256;
+const double switchNoteFrequency = 250.0;
+const double continuityBudgetDb = 1.5;
+
+std::vector<SwitchCase> makeSwitchCases() {
+  std::vector<SwitchCase> cases;
+
+  auto addOversamplingSwitch = [&cases](int from, int to) {
+    cases.push_back({"switch/oversampling " + juce::String(1 << from) + "x to " +
+                         juce::String(1 << to) + "x",
+                     from, [to](FuzzaAudioProcessor &processor) {
+                       setParameter(processor, "OVERSAMPLING",
+                                    static_cast<float>(to));
+                     }});
+  };
+
+  addOversamplingSwitch(0, 1);
+  addOversamplingSwitch(1, 3);
+  addOversamplingSwitch(3, 0);
+
+  cases.push_back({"switch/program reload", 0,
+                   [](FuzzaAudioProcessor &processor) {
+                     processor.setCurrentProgram(processor.getCurrentProgram());
+                   }});
+  return cases;
+}
+
+// Worst level change (dB) of any one-period window after the switch
+double runSwitchCase(const SwitchCase &test) {
+  FuzzaAudioProcessor processor;
+  processor.setPlayConfigDetails(2, 2, switchSampleRate, switchBlockSize);
+
+  setParameter(processor, "OVERSAMPLING", static_cast<float>(test.oversampling));
+  setParameter(processor, "GAIN", 50.0f);
+  setParameter(processor, "MIX", 100.0f);
+  setParameter(processor, "GATE", 30.0f);
+  processor.prepareToPlay(switchSampleRate, switchBlockSize);
+
+  const auto period = juce::roundToInt(switchSampleRate / switchNoteFrequency);
+  const auto settleBlocks =
+      juce::roundToInt(0.5 * switchSampleRate / switchBlockSize);
+  const auto measureBlocks =
+      juce::roundToInt(0.1 * switchSampleRate / switchBlockSize);
+
+  juce::AudioBuffer<float> block(2, switchBlockSize);
+  juce::MidiBuffer midi;
+  std::vector<float> output;
+  int phase = 0;
+  int switchSample = 0;
+
+  for (int index = 0; index < settleBlocks + measureBlocks; ++index) {
+    if (index == settleBlocks) {
+      test.change(processor);
+      switchSample = static_cast<int>(output.size());
+    }
+
+    for (int sample = 0; sample < switchBlockSize; ++sample, ++phase) {
+      auto value = 0.3f * static_cast<float>(std::sin(
+                              juce::MathConstants<double>::twoPi * phase /
+                              period));
+
+      for (int channel = 0; channel < 2; ++channel)
+        block.getWritePointer(channel)[sample] = value;
+    }
+
+    processor.processBlock(block, midi);
+    auto *data = block.getReadPointer(0);
+    output.insert(output.end(), data, data + switchBlockSize);
+  }
+
+  auto windowLevel = [&output, period](int end) {
+    double sum = 0.0;
+
+    for (int sample = end - period; sample < end; ++sample)
+      sum += static_cast<double>(output[static_cast<size_t>(sample)]) *
+             output[static_cast<size_t>(sample)];
+
+    return std::sqrt(sum / period);
+  };
+
+  const auto before = windowLevel(switchSample);
+  double worst = 0.0;
+
+  for (auto end = switchSample + period / 4;
+       end <= static_cast<int>(output.size()); end += period / 4) {
+    auto level = windowLevel(end);
+    auto change = juce::Decibels::gainToDecibels(level, -120.0) -
+                  juce::Decibels::gainToDecibels(before, -120.0);
+    worst = std::abs(change) > std::abs(worst) ? change : worst;
+  }
+
+  return worst;
+}
+
+// Bypassed, the output must be the input delayed by exactly the reported
+// latency, including blocks longer than the prepared block size. Returns
+// the largest difference.
+double runBypassCase(int oversampling) {
+  FuzzaAudioProcessor processor;
+  processor.setPlayConfigDetails(2, 2, switchSampleRate, switchBlockSize);
+
+  setParameter(processor, "OVERSAMPLING", static_cast<float>(oversampling));
+  setParameter(processor, "BYPASS", 1.0f);
+  processor.prepareToPlay(switchSampleRate, switchBlockSize);
+
+  const auto latency = processor.getLatencySamples();
+  const int blockSizes[] = {switchBlockSize, 100, 4 * switchBlockSize, 1};
+  juce::Random random(oversampling + 1);
+  juce::MidiBuffer midi;
+  std::vector<float> input, output;
+
+  for (int index = 0; index < 64; ++index) {
+    juce::AudioBuffer<float> block(2, blockSizes[index % 4]);
+
+    for (int sample = 0; sample < block.getNumSamples(); ++sample) {
+      auto value = random.nextFloat() * 2.0f - 1.0f;
+      input.push_back(value);
+
+      for (int channel = 0; channel < 2; ++channel)
+        block.getWritePointer(channel)[sample] = value;
+    }
+
+    processor.processBlock(block, midi);
+    auto *data = block.getReadPointer(1);
+    output.insert(output.end(), data, data + block.getNumSamples());
+  }
+
+  double worst = 0.0;
+
+  for (size_t sample = 0; sample < output.size(); ++sample) {
+    auto expected = sample < static_cast<size_t>(latency)
+                        ? 0.0f
+                        : input[sample - static_cast<size_t>(latency)];
+    worst = juce::jmax(worst, std::abs(static_cast<double>(output[sample]) -
+                                       expected));
+  }
+
+  return worst;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  const auto filter = args.getValueForOption("--filter");
+  const auto verbose = args.containsOption("--verbose");
+  const auto updateGolden = args.containsOption("--update-golden");
+
+  juce::File goldenFile;
+  std::map<juce::String, juce::String> golden;
+
+  if (args.containsOption("--golden")) {
+    goldenFile = args.getFileForOption("--golden");
+
+    if (auto *cases = juce::JSON::parse(goldenFile)
+                          .getProperty("cases", {})
+                          .getDynamicObject())
+      for (auto &entry : cases->getProperties())
+        golden[entry.name.toString()] = entry.value.toString();
+
+    if (golden.empty() && !updateGolden)
+      std::cerr << "No golden hashes in " << goldenFile.getFullPathName()
+                << "; record them with --update-golden (target "
+                   "FuzzaNullTestGolden)\n";
+  }
+
+  juce::DynamicObject::Ptr recorded = new juce::DynamicObject();
+  std::map<juce::String, Budget> worstCases;
+  int numRun = 0, numFailed = 0;
+
+  for (auto &test : makeTestCases()) {
+    if (filter.isNotEmpty() && !test.name.contains(filter))
+      continue;
+
+    auto result = runCase(test);
+    ++numRun;
+
+    if (!result.supported) {
+      std::cerr << test.name << ": bus not supported\n";
+      ++numFailed;
+      continue;
+    }
+
+    recorded->setProperty(test.name, result.hash);
+
+    juce::StringArray failures;
+
+    // Cases without a reference only have their hash checked
+    if (test.hasReference()) {
+      const auto budgetName =
+          test.gate              ? juce::String("Gate")
+          : test.doublePrecision ? juce::String("64-bit")
+                                 : juce::String(precisionNames[test.precision]);
+      const auto &budget = test.gate              ? gateBudget
+                           : test.doublePrecision ? doublePrecisionBudget
+                                                  : budgets[test.precision];
+
+      auto &worst = worstCases[budgetName];
+      worst.maxAbs = juce::jmax(worst.maxAbs, result.maxAbs);
+      worst.rms = juce::jmax(worst.rms, result.rms);
+
+      if (result.maxAbs > budget.maxAbs)
+        failures.add("max abs " + juce::String(result.maxAbs) + " > " +
+                     juce::String(budget.maxAbs));
+
+      if (result.rms > budget.rms)
+        failures.add("RMS " + juce::String(result.rms) + " > " +
+                     juce::String(budget.rms));
+    }
+
+    auto expectedHash = golden.find(test.name);
+
+    if (goldenFile != juce::File() && !updateGolden) {
+      if (expectedHash == golden.end())
+        failures.add("no golden hash (hash " + result.hash + ")");
+      else if (expectedHash->second != result.hash)
+        failures.add("hash " + result.hash + " != golden " +
+                     expectedHash->second);
+    }
+
+    if (!failures.isEmpty())
+      ++numFailed;
+
+    if (verbose || !failures.isEmpty())
+      std::cerr << test.name << ": max abs " << result.maxAbs << ", RMS "
+                << result.rms << ", hash " << result.hash
+                << (failures.isEmpty() ? "" : " FAILED: ")
+                << failures.joinIntoString(", ") << "\n";
+  }
+
+  for (auto &test : makeSwitchCases()) {
+    if (filter.isNotEmpty() && !test.name.contains(filter))
+      continue;
+
+    auto change = runSwitchCase(test);
+    auto failed = std::abs(change) > continuityBudgetDb;
+    ++numRun;
+
+    if (failed)
+      ++numFailed;
+
+    if (verbose || failed)
+      std::cerr << test.name << ": level change " << change << " dB"
+                << (failed ? " FAILED: > " + juce::String(continuityBudgetDb) +
+                                 " dB"
+                           : juce::String())
+                << "\n";
+  }
+
+  for (int oversampling = 0; oversampling < 4; ++oversampling) {
+    const auto name =
+        "bypass/" + juce::String(1 << oversampling) + "x latency";
+
+    if (filter.isNotEmpty() && !name.contains(filter))
+      continue;
+
+    auto difference = runBypassCase(oversampling);
+    auto failed = difference > 0.0;
+    ++numRun;
+
+    if (failed)
+      ++numFailed;
+
+    if (verbose || failed)
+      std::cerr << name << ": max difference " << difference
+                << (failed ? " FAILED: not the delayed input" : "") << "\n";
+  }
+
+  if (updateGolden && goldenFile != juce::File()) {
+    auto *report = new juce::DynamicObject();
+    report->setProperty("version", JucePlugin_VersionString);
+    report->setProperty("cases", juce::var(recorded.get()));
+
+    if (!goldenFile.replaceWithText(juce::JSON::toString(juce::var(report)))) {
+      std::cerr << "Cannot write " << goldenFile.getFullPathName() << "\n";
+      return 1;
+    }
+
+    std::cout << "Recorded " << recorded->getProperties().size()
+              << " golden hashes in " << goldenFile.getFullPathName()
+              << std::endl;
+  }
+
+  // What the budgets are set from
+  for (auto &[budgetName, worst] : worstCases)
+    std::cout << "Worst case " << budgetName << ": max abs " << worst.maxAbs
+              << ", RMS " << worst.rms << "\n";
+
+  std::cout << numRun - numFailed << " of " << numRun << " cases passed"
+            << std::endl;
+
+  if (!fuzza::tools::checkRealtimeSafety())
+    return 1;
+
+  return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,406 @@
+// FuzzaRender: offline batch reamp of audio files through FuzzaAudioProcessor.
+//
+// Each file is streamed through a processor in fixed-size chunks, so memory
+// stays at one chunk per worker whatever the file length. Files are spread
+// across all cores with a work-stealing pool, one processor instance per
+// worker. Oversampling latency is compensated, so every output lines up
+// sample for sample with its input. Outputs keep the input's format, channel
+// count, sample rate and bit depth.
+//
+// Parameters come from a state blob saved with getStateInformation
+// (--state) and/or individual settings in parameter units (--set, may be
+// repeated; applied after --state). --save-state writes the resulting blob
+// so a parameter set can be reused as a --state file.
+//
+// Usage: FuzzaRender [--state=preset.bin] [--set=GAIN=80 --set=CLIP_MODE=1]
+//                    [--output-dir=dir] [--suffix=_fuzza] [--threads=N]
+//                    [--block=512] [--list=files.txt] [--save-state=file]
+//                    file.wav file.aif ...
+
+#include "ToolUtilities.h"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace {
+
+const int defaultBlockSize = 512;
+const juce::String defaultSuffix = "_fuzza";
+
+// Jobs are indices into the file list. Each worker takes from the front of
+// its own deque and, once that is empty, steals from the back of the others,
+// so a few long takes cannot leave the remaining cores idle.
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(int numWorkers)
+      : queues(static_cast<size_t>(numWorkers)) {}
+
+  // Call before run(); jobs are dealt round-robin
+  void add(int job) {
+    queues[nextQueue].jobs.push_back(job);
+    nextQueue = (nextQueue + 1) % queues.size();
+  }
+
+  // Runs work(worker, job) until every queue is empty
+  template <typename Work> void run(Work &&work) {
+    std::vector<std::thread> threads;
+
+    for (size_t worker = 0; worker < queues.size(); ++worker)
+      threads.emplace_back([this, worker, &work] {
+        while (auto job = take(worker))
+          work(static_cast<int>(worker), *job);
+      });
+
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+private:
+  struct Queue {
+    std::mutex lock;
+    std::deque<int> jobs;
+  };
+
+  std::optional<int> take(size_t worker) {
+    {
+      auto &own = queues[worker];
+      std::lock_guard<std::mutex> guard(own.lock);
+
+      if (!own.jobs.empty()) {
+        auto job = own.jobs.front();
+        own.jobs.pop_front();
+        return job;
+      }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+      auto &victim = queues[(worker + offset) % queues.size()];
+      std::lock_guard<std::mutex> guard(victim.lock);
+
+      if (!victim.jobs.empty()) {
+        auto job = victim.jobs.back();
+        victim.jobs.pop_back();
+        return job;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  std::vector<Queue> queues;
+  size_t nextQueue = 0;
+};
+
+struct RenderResult {
+  bool succeeded = false;
+  juce::String error;
+  double audioSeconds = 0.0;
+  double renderSeconds = 0.0;
+};
+
+RenderResult renderFile(FuzzaAudioProcessor &processor,
+                        juce::AudioFormatManager &formats,
+                        const juce::File &input, const juce::File &output,
+                        int blockSize) {
+  RenderResult result;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::unique_ptr<juce::AudioFormatReader> reader(
+      formats.createReaderFor(input));
+
+  if (reader == nullptr) {
+    result.error = "unsupported or unreadable file";
+    return result;
+  }
+
+  const auto numChannels = static_cast<int>(reader->numChannels);
+  const auto sampleRate = reader->sampleRate;
+  const auto length = reader->lengthInSamples;
+
+  processor.setPlayConfigDetails(numChannels, numChannels, sampleRate,
+                                 blockSize);
+
+  if (processor.getTotalNumInputChannels() != numChannels) {
+    result.error = juce::String(numChannels) + " channels are not supported";
+    return result;
+  }
+
+  processor.setNonRealtime(true);
+  processor.prepareToPlay(sampleRate, blockSize);
+
+  // Same format as the input, at its bit depth where the writer supports it
+  auto *format = formats.findFormatForFileExtension(input.getFileExtension());
+
+  if (format == nullptr)
+    format = formats.getDefaultFormat();
+
+  auto bitDepth = static_cast<int>(reader->bitsPerSample);
+
+  if (!format->getPossibleBitDepths().contains(bitDepth))
+    bitDepth = 24;
+
+  output.deleteFile();
+  auto stream = output.createOutputStream();
+
+  if (stream == nullptr) {
+    result.error = "cannot create " + output.getFullPathName();
+    return result;
+  }
+
+  std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(
+      stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+      bitDepth, reader->metadataValues, 0));
+
+  if (writer == nullptr) {
+    result.error = "cannot write " + format->getFormatName();
+    return result;
+  }
+
+  stream.release(); // Now owned by the writer
+
+  juce::AudioBuffer<float> chunk(numChannels, blockSize);
+  juce::MidiBuffer midi;
+
+  // The first `latency` output samples precede the input; drop them and run
+  // the same amount of silence past the end of the file instead
+  auto samplesToSkip = static_cast<juce::int64>(processor.getLatencySamples());
+  juce::int64 readPosition = 0, written = 0;
+
+  while (written < length) {
+    chunk.clear();
+
+    auto numToRead = static_cast<int>(
+        juce::jlimit<juce::int64>(0, blockSize, length - readPosition));
+
+    if (numToRead > 0)
+      reader->read(&chunk, 0, numToRead, readPosition, true, true);
+
+    readPosition += blockSize;
+    processor.processBlock(chunk, midi);
+
+    auto offset =
+        static_cast<int>(juce::jmin<juce::int64>(samplesToSkip, blockSize));
+    samplesToSkip -= offset;
+
+    auto numToWrite = static_cast<int>(
+        juce::jmin<juce::int64>(blockSize - offset, length - written));
+
+    if (numToWrite > 0 &&
+        !writer->writeFromAudioSampleBuffer(chunk, offset, numToWrite)) {
+      result.error = "write failed";
+      return result;
+    }
+
+    written += numToWrite;
+  }
+
+  processor.releaseResources();
+
+  result.succeeded = true;
+  result.audioSeconds = static_cast<double>(length) / sampleRate;
+  result.renderSeconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  return result;
+}
+
+// Applies --state and every --set=ID=value to the processor
+bool applySettings(FuzzaAudioProcessor &processor,
+                   const juce::ArgumentList &args,
+                   const juce::MemoryBlock &state) {
+  if (!state.isEmpty())
+    processor.setStateInformation(state.getData(),
+                                  static_cast<int>(state.getSize()));
+
+  for (auto &argument : args.arguments) {
+    if (!argument.text.startsWith("--set="))
+      continue;
+
+    auto setting = argument.text.fromFirstOccurrenceOf("--set=", false, false);
+    auto id = setting.upToFirstOccurrenceOf("=", false, false);
+    auto value = setting.fromFirstOccurrenceOf("=", false, false);
+
+    if (id.isEmpty() || value.isEmpty() ||
+        !fuzza::tools::setParameter(processor, id, value.getFloatValue())) {
+      std::cerr << "Unknown or malformed setting: " << setting << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  // Inputs: positional arguments plus one path per line from --list
+  juce::Array<juce::File> inputs;
+
+  for (auto &argument : args.arguments)
+    if (!argument.isOption())
+      inputs.add(argument.resolveAsFile());
+
+  if (args.containsOption("--list")) {
+    juce::StringArray lines;
+    args.getFileForOption("--list").readLines(lines);
+
+    for (auto &line : lines)
+      if (line.trim().isNotEmpty())
+        inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(
+            line.trim()));
+  }
+
+  if (inputs.isEmpty() && !args.containsOption("--save-state")) {
+    std::cerr << "Usage: FuzzaRender [--state=preset.bin] [--set=ID=value ...] "
+                 "[--output-dir=dir] [--suffix=_fuzza] [--threads=N] "
+                 "[--block=512] [--list=files.txt] [--save-state=file] "
+                 "files..."
+              << std::endl;
+    return 1;
+  }
+
+  juce::MemoryBlock state;
+
+  if (args.containsOption("--state") &&
+      !args.getFileForOption("--state").loadFileAsData(state)) {
+    std::cerr << "Cannot read " << args.getValueForOption("--state")
+              << std::endl;
+    return 1;
+  }
+
+  auto blockSize = args.containsOption("--block")
+                       ? args.getValueForOption("--block").getIntValue()
+                       : defaultBlockSize;
+  blockSize = juce::jmax(1, blockSize);
+
+  auto suffix = args.containsOption("--suffix")
+                    ? args.getValueForOption("--suffix")
+                    : defaultSuffix;
+
+  juce::File outputDirectory;
+
+  if (args.containsOption("--output-dir")) {
+    outputDirectory = args.getFileForOption("--output-dir");
+
+    if (!outputDirectory.createDirectory()) {
+      std::cerr << "Cannot create " << outputDirectory.getFullPathName()
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // Output paths, resolved up front: an empty --suffix without --output-dir,
+  // or an output named like another input, would delete a source file
+  juce::Array<juce::File> outputs;
+
+  for (auto &input : inputs) {
+    auto directory = outputDirectory == juce::File()
+                         ? input.getParentDirectory()
+                         : outputDirectory;
+    auto output = directory.getChildFile(input.getFileNameWithoutExtension() +
+                                         suffix + input.getFileExtension());
+
+    if (inputs.contains(output)) {
+      std::cerr << "Refusing to overwrite input " << output.getFullPathName()
+                << " (use --output-dir or a different --suffix)" << std::endl;
+      return 1;
+    }
+
+    if (outputs.contains(output)) {
+      std::cerr << "Two inputs would both render to "
+                << output.getFullPathName() << std::endl;
+      return 1;
+    }
+
+    outputs.add(output);
+  }
+
+  auto numWorkers = args.containsOption("--threads")
+                        ? args.getValueForOption("--threads").getIntValue()
+                        : juce::SystemStats::getNumCpus();
+  numWorkers = juce::jlimit(1, juce::jmax(1, inputs.size()), numWorkers);
+
+  // One configured processor per worker, created on this (message) thread
+  std::vector<std::unique_ptr<FuzzaAudioProcessor>> processors;
+
+  for (int worker = 0; worker < numWorkers; ++worker) {
+    processors.push_back(std::make_unique<FuzzaAudioProcessor>());
+
+    if (!applySettings(*processors.back(), args, state))
+      return 1;
+  }
+
+  if (args.containsOption("--save-state")) {
+    juce::MemoryBlock savedState;
+    processors.front()->getStateInformation(savedState);
+
+    if (!args.getFileForOption("--save-state").replaceWithData(
+            savedState.getData(), savedState.getSize())) {
+      std::cerr << "Cannot write " << args.getValueForOption("--save-state")
+                << std::endl;
+      return 1;
+    }
+
+    if (inputs.isEmpty())
+      return 0;
+  }
+
+  WorkStealingPool pool(numWorkers);
+
+  for (int job = 0; job < inputs.size(); ++job)
+    pool.add(job);
+
+  std::vector<RenderResult> results(static_cast<size_t>(inputs.size()));
+  std::mutex logLock;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  pool.run([&](int worker, int job) {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    auto &input = inputs.getReference(job);
+    auto &output = outputs.getReference(job);
+
+    auto &result = results[static_cast<size_t>(job)];
+    result = renderFile(*processors[static_cast<size_t>(worker)], formats,
+                        input, output, blockSize);
+
+    std::lock_guard<std::mutex> guard(logLock);
+
+    if (result.succeeded)
+      std::cerr << input.getFileName() << " -> " << output.getFullPathName()
+                << " (" << result.audioSeconds / result.renderSeconds
+                << "x realtime)\n";
+    else
+      std::cerr << input.getFileName() << ": " << result.error << "\n";
+  });
+
+  const auto wallSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  double audioSeconds = 0.0;
+  int numFailed = 0;
+
+  for (auto &result : results) {
+    audioSeconds += result.audioSeconds;
+    numFailed += result.succeeded ? 0 : 1;
+  }
+
+  std::cout << inputs.size() - numFailed << " of " << inputs.size()
+            << " files, " << audioSeconds << " s of audio in " << wallSeconds
+            << " s on " << numWorkers << " threads: "
+            << audioSeconds / wallSeconds << "x realtime ("
+            << audioSeconds / wallSeconds / numWorkers << "x per thread)"
+            << std::endl;
+
+  return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,446 @@
+// FuzzaStress: real-time deadline simulator and thread-contention stress
+// test for FuzzaAudioProcessor.
+//
+// An audio thread (real-time priority where the OS grants it) calls
+// processBlock at an exact simulated device cadence: block k is due at
+// start + k * blockSize / sampleRate and must be finished one block period
+// later. Meanwhile other threads do what hosts and the editor do
+// concurrently:
+//
+//   automation threads   random values for every APVTS parameter, with
+//                        change gestures as the editor's buttons and
+//                        sliders send them
+//   state thread         getStateInformation / setStateInformation round
+//                        trips, program changes and a 30 Hz telemetry drain
+//                        (the editor's timer)
+//
+// Throughput says nothing about jitter, so every block's callback latency
+// (scheduled start to finished) is kept, and the worst case, p99 and p99.9
+// are reported with the number of missed deadlines. Every output sample is
+// checked to be finite and bounded; a torn parameter or state read shows up
+// there first.
+//
+// Data races in the strict sense need ThreadSanitizer: configure with
+// -DFUZZA_THREAD_SANITIZER=ON and every race is reported with both stacks
+// (and the process exits nonzero). The report says whether this build has
+// it.
+//
+// Exits with 1 on invalid output, or on more deadline misses than
+// --max-misses allows (no limit by default: a shared CI machine misses
+// deadlines for reasons of its own), or, in a FUZZA_REALTIME_SANITIZER
+// build, if processBlock allocated, locked or blocked.
+//
+// Usage: FuzzaStress [--seconds=10] [--sample-rate=48000] [--block=32]
+//                    [--channels=2] [--threads=2] [--max-misses=N]
+//                    [--double] [--output=file.json]
+
+#include "ToolUtilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+
+#if defined(__SANITIZE_THREAD__)
+#define FUZZA_HAS_THREAD_SANITIZER 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define FUZZA_HAS_THREAD_SANITIZER 1
+#endif
+#endif
+
+#ifndef FUZZA_HAS_THREAD_SANITIZER
+#define FUZZA_HAS_THREAD_SANITIZER 0
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Output beyond this is treated as broken (the hottest settings stay far
+// below it)
+const float maximumOutput = 64.0f;
+
+// The audio thread sleeps until this close to a block's start, then spins
+const auto spinMargin = std::chrono::microseconds(200);
+
+struct Settings {
+  double seconds = 10.0;
+  double sampleRate = 48000.0;
+  int blockSize = 32;
+  int numChannels = 2;
+  int numAutomationThreads = 2;
+  int maximumMisses = -1;
+  bool doublePrecision = false;
+};
+
+// Looping plucked notes over a noise floor, long enough not to repeat per
+// block
+template <typename SampleType>
+juce::AudioBuffer<SampleType> makeTestSignal(double sampleRate,
+                                             int numChannels) {
+  const auto numSamples = static_cast<int>(sampleRate);
+  juce::AudioBuffer<SampleType> signal(numChannels, numSamples);
+  juce::Random random(0x53747273);
+
+  const float noteFrequencies[] = {82.41f, 110.0f, 146.83f, 196.0f};
+  const auto noteLength = numSamples / 4;
+
+  for (int channel = 0; channel < numChannels; ++channel) {
+    auto *data = signal.getWritePointer(channel);
+
+    for (int sample = 0; sample < numSamples; ++sample) {
+      auto note = sample / noteLength;
+      auto t = static_cast<float>((sample % noteLength) / sampleRate);
+      auto phase = juce::MathConstants<float>::twoPi * noteFrequencies[note] * t;
+      auto envelope = 0.6f * std::exp(-3.0f * t);
+      auto noise = 0.003f * (random.nextFloat() * 2.0f - 1.0f);
+
+      data[sample] = static_cast<SampleType>(
+          envelope * std::sin(phase + 0.5f * channel) + noise);
+    }
+  }
+
+  return signal;
+}
+
+// What the audio thread measured. Written by the audio thread only and read
+// after it has stopped.
+struct AudioResults {
+  std::vector<double> latencies;   // Scheduled start to finished (s)
+  std::vector<double> processings; // processBlock alone (s)
+  int numBlocks = 0;
+  int deadlineMisses = 0;
+  juce::int64 invalidSamples = 0;
+  bool realtimePriority = false;
+};
+
+class AudioThread : public juce::Thread {
+public:
+  AudioThread(FuzzaAudioProcessor &processorToUse, const Settings &settingsToUse)
+      : juce::Thread("FuzzaStress audio"), processor(processorToUse),
+        settings(settingsToUse),
+        numBlocks(static_cast<int>(settings.seconds * settings.sampleRate /
+                                   settings.blockSize)) {
+    results.latencies.reserve(static_cast<size_t>(numBlocks));
+    results.processings.reserve(static_cast<size_t>(numBlocks));
+  }
+
+  ~AudioThread() override { stopThread(-1); }
+
+  void start() {
+    // The period lets the OS size its real-time slice (macOS workgroups,
+    // Linux SCHED_FIFO where permitted)
+    results.realtimePriority = startRealtimeThread(
+        juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(
+            settings.blockSize, settings.sampleRate));
+
+    if (!results.realtimePriority)
+      startThread(juce::Thread::Priority::highest);
+  }
+
+  const AudioResults &getResults() const { return results; }
+
+private:
+  void run() override {
+    if (settings.doublePrecision)
+      runBlocks<double>();
+    else
+      runBlocks<float>();
+  }
+
+  template <typename SampleType> void runBlocks() {
+    const auto signal =
+        makeTestSignal<SampleType>(settings.sampleRate, settings.numChannels);
+    juce::AudioBuffer<SampleType> block(settings.numChannels,
+                                        settings.blockSize);
+    juce::MidiBuffer midi;
+
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(settings.blockSize /
+                                      settings.sampleRate));
+    const auto start = Clock::now() + period;
+    int readPosition = 0;
+
+    for (int index = 0; index < numBlocks && !threadShouldExit(); ++index) {
+      // Like a device: block k is due at a fixed time whether or not the
+      // previous one was late
+      const auto due = start + index * period;
+
+      if (due - Clock::now() > spinMargin)
+        std::this_thread::sleep_until(due - spinMargin);
+
+      while (Clock::now() < due) {
+      }
+
+      for (int channel = 0; channel < settings.numChannels; ++channel)
+        block.copyFrom(channel, 0, signal, channel, readPosition,
+                       settings.blockSize);
+
+      readPosition = (readPosition + settings.blockSize) %
+                     (signal.getNumSamples() - settings.blockSize);
+
+      const auto begin = Clock::now();
+      processor.processBlock(block, midi);
+      const auto end = Clock::now();
+
+      results.processings.push_back(
+          std::chrono::duration<double>(end - begin).count());
+      results.latencies.push_back(
+          std::chrono::duration<double>(end - due).count());
+
+      if (end > due + period)
+        ++results.deadlineMisses;
+
+      for (int channel = 0; channel < settings.numChannels; ++channel)
+        for (int sample = 0; sample < settings.blockSize; ++sample) {
+          auto value = block.getSample(channel, sample);
+
+          if (!std::isfinite(value) ||
+              std::abs(value) > static_cast<SampleType>(maximumOutput))
+            ++results.invalidSamples;
+        }
+
+      ++results.numBlocks;
+    }
+  }
+
+  FuzzaAudioProcessor &processor;
+  const Settings settings;
+  const int numBlocks;
+  AudioResults results;
+};
+
+// Random values for every parameter, as host automation and the editor's
+// controls send them
+class AutomationThread : public juce::Thread {
+public:
+  AutomationThread(FuzzaAudioProcessor &processorToUse, int seed)
+      : juce::Thread("FuzzaStress automation"), processor(processorToUse),
+        random(seed) {}
+
+  ~AutomationThread() override { stopThread(-1); }
+
+  juce::int64 getNumChanges() const { return numChanges.load(); }
+
+private:
+  void run() override {
+    const auto &parameters = processor.getParameters();
+
+    while (!threadShouldExit()) {
+      auto *parameter = dynamic_cast<juce::RangedAudioParameter *>(
+          parameters[random.nextInt(parameters.size())]);
+
+      if (parameter == nullptr)
+        continue;
+
+      // A click or a short drag
+      const auto numSteps = random.nextBool() ? 1 : 1 + random.nextInt(8);
+      parameter->beginChangeGesture();
+
+      for (int i = 0; i < numSteps; ++i)
+        parameter->setValueNotifyingHost(random.nextFloat());
+
+      parameter->endChangeGesture();
+      numChanges += numSteps;
+
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(random.nextInt(200)));
+    }
+  }
+
+  FuzzaAudioProcessor &processor;
+  juce::Random random;
+  std::atomic<juce::int64> numChanges{0};
+};
+
+double getPercentile(std::vector<double> values, double percentile) {
+  if (values.empty())
+    return 0.0;
+
+  const auto index = std::min(
+      values.size() - 1,
+      static_cast<size_t>(percentile / 100.0 * static_cast<double>(values.size())));
+  std::nth_element(values.begin(),
+                   values.begin() + static_cast<std::ptrdiff_t>(index),
+                   values.end());
+  return values[index];
+}
+
+double getMaximum(const std::vector<double> &values) {
+  return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  Settings settings;
+  auto option = [&args](const char *name, auto fallback) {
+    if (!args.containsOption(name))
+      return fallback;
+
+    const auto value = args.getValueForOption(name);
+
+    if constexpr (std::is_same_v<decltype(fallback), double>)
+      return value.getDoubleValue();
+    else
+      return value.getIntValue();
+  };
+
+  settings.seconds = option("--seconds", settings.seconds);
+  settings.sampleRate = option("--sample-rate", settings.sampleRate);
+  settings.blockSize = juce::jmax(1, option("--block", settings.blockSize));
+  settings.numChannels = juce::jmax(1, option("--channels", settings.numChannels));
+  settings.numAutomationThreads =
+      juce::jmax(0, option("--threads", settings.numAutomationThreads));
+  settings.maximumMisses = option("--max-misses", settings.maximumMisses);
+  settings.doublePrecision = args.containsOption("--double");
+  auto outputPath = args.getValueForOption("--output");
+
+  FuzzaAudioProcessor processor;
+  processor.setPlayConfigDetails(settings.numChannels, settings.numChannels,
+                                 settings.sampleRate, settings.blockSize);
+
+  if (processor.getTotalNumInputChannels() != settings.numChannels) {
+    std::cerr << settings.numChannels << " channels are not supported\n";
+    return 1;
+  }
+
+  if (settings.doublePrecision)
+    processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+  processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+
+  AudioThread audioThread(processor, settings);
+  std::vector<std::unique_ptr<AutomationThread>> automationThreads;
+
+  for (int i = 0; i < settings.numAutomationThreads; ++i)
+    automationThreads.push_back(
+        std::make_unique<AutomationThread>(processor, 0x41757430 + i));
+
+  audioThread.start();
+
+  for (auto &thread : automationThreads)
+    thread->startThread();
+
+  // This thread stands in for the message thread: state round trips,
+  // program changes and the editor's telemetry drain
+  juce::Random random(0x53746174);
+  juce::int64 stateRoundTrips = 0, programChanges = 0, telemetryBlocks = 0;
+  auto nextDrain = Clock::now();
+
+  while (audioThread.isThreadRunning()) {
+    juce::MemoryBlock state;
+    processor.getStateInformation(state);
+    processor.setStateInformation(state.getData(),
+                                  static_cast<int>(state.getSize()));
+    ++stateRoundTrips;
+
+    if (random.nextInt(8) == 0) {
+      processor.setCurrentProgram(random.nextInt(processor.getNumPrograms()));
+      ++programChanges;
+    }
+
+    if (Clock::now() >= nextDrain) {
+      fuzza::BlockTelemetry block;
+
+      while (processor.telemetry.pop(block))
+        ++telemetryBlocks;
+
+      nextDrain += std::chrono::milliseconds(33);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  juce::int64 parameterChanges = 0;
+
+  for (auto &thread : automationThreads) {
+    thread->stopThread(-1);
+    parameterChanges += thread->getNumChanges();
+  }
+
+  processor.releaseResources();
+
+  const auto &results = audioThread.getResults();
+  auto microseconds = [](double seconds) { return seconds * 1.0e6; };
+  const auto deadline = settings.blockSize / settings.sampleRate;
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("version", JucePlugin_VersionString);
+  report->setProperty("sampleRate", settings.sampleRate);
+  report->setProperty("blockSize", settings.blockSize);
+  report->setProperty("channels", settings.numChannels);
+  report->setProperty("doublePrecision", settings.doublePrecision);
+  report->setProperty("realtimePriority", results.realtimePriority);
+  report->setProperty("threadSanitizer", FUZZA_HAS_THREAD_SANITIZER != 0);
+  report->setProperty("realtimeSanitizer",
+                      fuzza::RealtimeSanitizer::isEnabled());
+  report->setProperty("realtimeViolations",
+                      static_cast<juce::int64>(
+                          fuzza::RealtimeSanitizer::getNumViolations()));
+  report->setProperty("blocks", results.numBlocks);
+  report->setProperty("deadlineUs", microseconds(deadline));
+  report->setProperty("deadlineMisses", results.deadlineMisses);
+  report->setProperty("worstLatencyUs", microseconds(getMaximum(results.latencies)));
+  report->setProperty("p99LatencyUs",
+                      microseconds(getPercentile(results.latencies, 99.0)));
+  report->setProperty("p999LatencyUs",
+                      microseconds(getPercentile(results.latencies, 99.9)));
+  report->setProperty("worstProcessingUs",
+                      microseconds(getMaximum(results.processings)));
+  report->setProperty("p999ProcessingUs",
+                      microseconds(getPercentile(results.processings, 99.9)));
+  report->setProperty("invalidSamples", results.invalidSamples);
+  report->setProperty("parameterChanges", parameterChanges);
+  report->setProperty("stateRoundTrips", stateRoundTrips);
+  report->setProperty("programChanges", programChanges);
+  report->setProperty("telemetryBlocks", telemetryBlocks);
+
+  auto json = juce::JSON::toString(juce::var(report));
+
+  if (outputPath.isEmpty()) {
+    std::cout << json << std::endl;
+  } else if (!juce::File::getCurrentWorkingDirectory()
+                  .getChildFile(outputPath)
+                  .replaceWithText(json)) {
+    std::cerr << "Could not write " << outputPath << std::endl;
+    return 1;
+  }
+
+  std::cerr << results.numBlocks << " blocks of " << settings.blockSize
+            << " at " << settings.sampleRate << " Hz: "
+            << results.deadlineMisses << " deadline misses, worst "
+            << microseconds(getMaximum(results.latencies)) << " us, p99.9 "
+            << microseconds(getPercentile(results.latencies, 99.9))
+            << " us of " << microseconds(deadline) << " us"
+            << (results.realtimePriority ? "" : " (no real-time priority)")
+            << "\n";
+
+  auto failed = false;
+
+  if (results.invalidSamples > 0) {
+    std::cerr << "FAIL: " << results.invalidSamples
+              << " non-finite or out-of-range output samples\n";
+    failed = true;
+  }
+
+  if (settings.maximumMisses >= 0 &&
+      results.deadlineMisses > settings.maximumMisses) {
+    std::cerr << "FAIL: more than " << settings.maximumMisses
+              << " deadline misses\n";
+    failed = true;
+  }
+
+  if (!fuzza::tools::checkRealtimeSafety())
+    failed = true;
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+// Frozen scalar reference of the Fuzza signal chain, used by FuzzaNullTest.
+//
+// This is the original per-sample processBlock loop with the behaviour
+// changes made since then folded in (every channel gets its own tone filter,
+// GATE 0% bypasses both gates), written for clarity and not for speed: plain
+// floats, std::tanh and one juce::dsp::StateVariableTPTFilter per channel.
+// It has no oversampling; the clipper runs at the host rate.
+//
+// Do not optimise or "tidy" this file. It defines what Fuzza should sound
+// like; production kernels are measured against it. Only change it together
+// with an intentional change to the sound, and say so in the changelog.
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <vector>
+
+namespace fuzza::tools {
+
+class ReferenceFuzz {
+public:
+  // Raw parameter values in their own units, as APVTS holds them
+  struct Settings {
+    float gain = 50.0f;            // GAIN 0-100
+    float toneFrequency = 2000.0f; // TONE (Hz)
+    float mix = 100.0f;            // MIX 0-100 %
+    float gate = 0.0f;             // GATE 0-100 %
+    int clipMode = 0;              // CLIP_MODE index
+  };
+
+  void prepare(double newSampleRate, int maximumBlockSize, int numChannels) {
+    sampleRate = newSampleRate;
+    toneFilters.resize(static_cast<size_t>(numChannels));
+
+    for (auto &filter : toneFilters) {
+      filter.prepare({sampleRate, static_cast<juce::uint32>(maximumBlockSize),
+                      1});
+      filter.reset();
+    }
+
+    inputGateGains.assign(static_cast<size_t>(numChannels), 0.0f);
+    outputGateGains.assign(static_cast<size_t>(numChannels), 0.0f);
+  }
+
+  void process(juce::AudioBuffer<float> &buffer, const Settings &settings) {
+    auto mixParam = settings.mix / 100.0f;
+    auto gateParam = settings.gate / 100.0f;
+
+    // Auto-compensation algorithm
+    float inputGain = juce::jmax(1.0f, settings.gain);
+    float makeupGain = 2.0f / std::sqrt(inputGain);
+
+    // Gate threshold (0.0 = no gate, 0.1 = aggressive)
+    float gateThreshold = gateParam * 0.1f;
+
+    // The cutoff jumps; production glides, so TONE is held in the null test
+    for (auto &filter : toneFilters)
+      filter.setCutoffFrequency(settings.toneFrequency);
+
+    const float alphaInputAttack =
+        static_cast<float>(std::exp(-1.0 / (sampleRate * 0.005)));
+    const float alphaInputRelease =
+        static_cast<float>(std::exp(-1.0 / (sampleRate * 0.05)));
+    const float alphaOutputAttack =
+        static_cast<float>(std::exp(-1.0 / (sampleRate * 0.02)));
+    const float alphaOutputRelease =
+        static_cast<float>(std::exp(-1.0 / (sampleRate * 0.5)));
+
+    const auto numChannels = juce::jmin(buffer.getNumChannels(),
+                                        static_cast<int>(toneFilters.size()));
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+      auto *channelData = buffer.getWritePointer(channel);
+      auto &toneFilter = toneFilters[static_cast<size_t>(channel)];
+      auto &inputGateGain = inputGateGains[static_cast<size_t>(channel)];
+      auto &outputGateGain = outputGateGains[static_cast<size_t>(channel)];
+
+      for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
+        float input = channelData[sample];
+
+        // --- Stage 1: Input Gate (Tight) ---
+        if (gateThreshold > 0.0f) {
+          float target = (std::abs(input) > gateThreshold) ? 1.0f : 0.0f;
+          float alpha =
+              target > inputGateGain ? alphaInputAttack : alphaInputRelease;
+          inputGateGain = (inputGateGain * alpha) + (target * (1.0f - alpha));
+        } else {
+          inputGateGain = 1.0f;
+        }
+
+        input *= inputGateGain;
+
+        float dry = input;
+        float wet = dry * inputGain;
+
+        // Clipping modes
+        switch (settings.clipMode) {
+          case 0: // Hard clipping
+            wet = juce::jlimit(-1.0f, 1.0f, wet);
+            break;
+
+          case 1: // Soft clipping (tanh)
+            wet = std::tanh(wet);
+            break;
+
+          case 2: // Asymmetric clipping (vintage style)
+            if (wet > 0.0f)
+              wet = std::tanh(wet * 1.5f);
+            else
+              wet = juce::jlimit(-1.0f, 1.0f, wet);
+            break;
+        }
+
+        // Tone filter (low-pass), makeup gain and mix
+        wet = toneFilter.processSample(0, wet);
+        wet *= makeupGain;
+
+        float mixed = (dry * (1.0f - mixParam)) + (wet * mixParam);
+
+        // --- Stage 2: Output Suppressor (Smooth), half threshold ---
+        if (gateThreshold > 0.0f) {
+          float target =
+              (std::abs(mixed) > gateThreshold * 0.5f) ? 1.0f : 0.0f;
+          float alpha =
+              target > outputGateGain ? alphaOutputAttack : alphaOutputRelease;
+          outputGateGain = (outputGateGain * alpha) + (target * (1.0f - alpha));
+        } else {
+          outputGateGain = 1.0f;
+        }
+
+        channelData[sample] = mixed * outputGateGain;
+      }
+    }
+  }
+
+private:
+  double sampleRate = 44100.0;
+  std::vector<juce::dsp::StateVariableTPTFilter<float>> toneFilters;
+  std::vector<float> inputGateGains, outputGateGains;
+};
+
+} // namespace fuzza::tools
@@ -0,0 +1,39 @@
+#pragma once
+
+// Helpers shared by the console tools
+
+#include "PluginProcessor.h"
+#include "RealtimeSanitizer.h"
+
+#include <iostream>
+
+namespace fuzza::tools {
+
+// Sets a parameter by ID in its own units (e.g. GAIN 0-100, CLIP_MODE index),
+// as a host would. Returns false if the ID does not exist.
+inline bool setParameter(FuzzaAudioProcessor &processor, const juce::String &id,
+                         float value) {
+  auto *parameter = processor.apvts.getParameter(id);
+
+  if (parameter == nullptr)
+    return false;
+
+  parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+  return true;
+}
+
+// In a FUZZA_REALTIME_SANITIZER build, false (with a message) if processBlock
+// allocated, locked or blocked during the run. The call sites were reported
+// on stderr as they happened.
+inline bool checkRealtimeSafety() {
+  const auto numViolations = RealtimeSanitizer::getNumViolations();
+
+  if (numViolations == 0)
+    return true;
+
+  std::cerr << "FAIL: " << numViolations
+            << " allocating, locking or blocking calls inside processBlock\n";
+  return false;
+}
+
+} // namespace fuzza::tools